@@ -1,40 +1,60 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 #include "interrupts.h"
 #include "alarm.h"
 #include "alarm_queue.h"
 #include "alarm_private.h"
 
-/* Nearest alarm ticks to fire */
+/* Time source of alarms */
+alarm_source_t alarm_source = ALARM_SOURCE_TICKS;
+
+/* Nearest alarm time to fire, on the alarm time source */
 long alarm_time;
 
-/* Next alarm id */
-int next_alarm_id = 0;
+/* Number of alarms registered so far, the upper bits of the next alarm id */
+long next_alarm_id = 0;
 
 /* Alarm queue */
 alarm_queue_t alarm_clock;
 
-/* Conversion from millisecond to period */
-static const int MS_TO_P = PERIOD / MILLISECOND;
+/*
+ * Pool of alarms, allocated in chunks and never freed. Each alarm keeps
+ * its slot of the table, the low bits of its id, so that it is found in
+ * constant time. Alarms not registered are linked in a free list.
+ */
+static alarm_t *alarm_table;
+static int alarm_table_size = 0;
+static alarm_t alarm_free;
+
+static void alarm_arm(long deadline);
+static int alarm_pool_grow();
+static alarm_t alarm_get();
+static void alarm_put(alarm_t alarm);
 
 /*
  * insert alarm event into the alarm queue
  * returns an "alarm id", which is an integer that identifies the
  * alarm.
  */
-int
+long
 register_alarm(int delay, void (*func)(void*), void *arg)
 {
     interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
-    alarm_t alarm = alarm_create(delay, func, arg);
+    alarm_t alarm = alarm_get();
+    long now = alarm_now();
     if (alarm == NULL) {
+        set_interrupt_level(oldlevel);
         return -1;
     }
-    /* Update nearest alarm to fire */
-    if (alarm->time_to_fire < alarm_time || -1 == alarm_time) {
-        alarm_time = alarm->time_to_fire;
-    }
+    /* Avoid setting alarm to the current tick */
+    alarm->time_to_fire = now + (delay > 0 ? delay : 1);
+    alarm->func = func;
+    alarm->arg = arg;
     alarm_queue_insert(alarm_clock, alarm);
+    /* Update nearest alarm to fire */
+    alarm_time = alarm_getnext(alarm_clock);
+    alarm_arm(alarm_time);
     set_interrupt_level(oldlevel);
     return alarm->alarm_id;
 }
@@ -44,30 +64,40 @@ register_alarm(int delay, void (*func)(void*), void *arg)
  * it is ok to try to delete an alarm that has already executed.
  */
 void
-deregister_alarm(int alarmid)
+deregister_alarm(long alarmid)
 {
     alarm_t alarm;
-    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
-    if (alarm_queue_delete_by_id(alarm_clock, alarmid, &alarm) != -1)
-        free(alarm);
+    interrupt_level_t oldlevel;
+    if (alarmid < 0)
+        return;
+    oldlevel = set_interrupt_level(DISABLED);
+    if ((alarmid & (ALARM_SLOTS_MAX - 1)) < alarm_table_size) {
+        alarm = alarm_table[alarmid & (ALARM_SLOTS_MAX - 1)];
+        /* An alarm not in the queue has fired or been deleted */
+        if (alarm->alarm_id == alarmid
+                && alarm_queue_delete(alarm_clock, &alarm) != -1)
+            alarm_put(alarm);
+    }
     set_interrupt_level(oldlevel);
 }
 
 /*
- * Create a new alarm structure
+ * Create a new alarm structure outside the pool, to be freed by the caller
  * Return NULL on failure, pointer to the alarm on success
  */
 alarm_t
 alarm_create(int delay, void (*func)(void*), void *arg)
 {
     alarm_t alarm = malloc(sizeof(struct alarm));
+    long now = alarm_now();
     if (alarm == NULL) {
         return NULL;
     }
-    alarm->alarm_id = next_alarm_id++;
-    alarm->time_to_fire = ticks + (delay / MS_TO_P);
-    if (alarm->time_to_fire == ticks) {
-        alarm->time_to_fire++; /* Avoid setting alarm to the current tick */
+    alarm->alarm_id = -1;
+    alarm->bucket = -1;
+    alarm->time_to_fire = now + delay;
+    if (alarm->time_to_fire <= now) {
+        alarm->time_to_fire = now + 1; /* Avoid setting alarm to the current tick */
     }
     alarm->func = func;
     alarm->arg = arg;
@@ -76,19 +106,111 @@ alarm_create(int delay, void (*func)(void*), void *arg)
     return alarm;
 }
 
-/* Fire all alarms before or at the current tick */
+/*
+ * Fire all alarms before or at the current time, then arm the next one.
+ * The due alarms are detached from the queue in one batch. Each goes back
+ * to the pool before its function is called, so the function may register
+ * alarms of its own.
+ */
 void
 alarm_signal()
 {
-    alarm_t alarm = NULL;
-    while ((alarm_time = alarm_getnext(alarm_clock)) != -1
-            && alarm_time <= ticks) {
-        if (alarm_queue_dequeue(alarm_clock, &alarm) != -1) {
-            alarm->func(alarm->arg);
-            free(alarm);
-//printf("Alarm fired at ticks: %ld\n", ticks);
-        }
+    alarm_t alarm;
+    alarm_t next;
+    void (*func)(void*);
+    void *arg;
+
+    alarm_queue_expire(alarm_clock, alarm_now(), &alarm);
+    for (; alarm != NULL; alarm = next) {
+        next = alarm->next;
+        func = alarm->func;
+        arg = alarm->arg;
+        alarm_put(alarm);
+        func(arg);
     }
+    alarm_time = alarm_getnext(alarm_clock);
+    alarm_arm(alarm_time);
+}
+
+/* Current time in milliseconds on the alarm time source */
+long
+alarm_now()
+{
+    if (ALARM_SOURCE_WALL == alarm_source)
+        return minithread_wall_now();
+    return minithread_clock_now();
+}
+
+/* Arm the clock of the alarm time source for deadline */
+static void
+alarm_arm(long deadline)
+{
+    if (ALARM_SOURCE_WALL == alarm_source)
+        minithread_wall_arm(deadline);
+    else
+        minithread_clock_arm(deadline);
+}
+
+/*
+ * Add a chunk of alarms to the pool, doubling its size.
+ * Return 0 on success, -1 on failure
+ */
+static int
+alarm_pool_grow()
+{
+    alarm_t *table;
+    alarm_t chunk;
+    int size;
+    int slot;
+
+    if (alarm_table_size == ALARM_SLOTS_MAX)
+        return -1;
+    size = (0 == alarm_table_size) ? ALARM_POOL_INIT : 2 * alarm_table_size;
+    if ((table = realloc(alarm_table, size * sizeof(alarm_t))) == NULL)
+        return -1;
+    alarm_table = table;
+    chunk = malloc((size - alarm_table_size) * sizeof(struct alarm));
+    if (NULL == chunk)
+        return -1;
+    for (slot = size - 1; slot >= alarm_table_size; --slot) {
+        alarm_t alarm = &chunk[slot - alarm_table_size];
+        alarm->alarm_id = slot;
+        alarm->bucket = -1;
+        alarm_table[slot] = alarm;
+        alarm->next = alarm_free;
+        alarm_free = alarm;
+    }
+    alarm_table_size = size;
+    return 0;
+}
+
+/*
+ * Take an alarm from the pool, growing it if needed, and give it a new
+ * id made of its slot and the registration count.
+ * Return NULL on failure
+ */
+static alarm_t
+alarm_get()
+{
+    alarm_t alarm;
+    if (NULL == alarm_free && alarm_pool_grow() == -1)
+        return NULL;
+    alarm = alarm_free;
+    alarm_free = alarm->next;
+    alarm->alarm_id = (long) ((((unsigned long) next_alarm_id++) << ALARM_SLOT_BITS
+                               | (alarm->alarm_id & (ALARM_SLOTS_MAX - 1)))
+                              & LONG_MAX);
+    alarm->prev = NULL;
+    alarm->next = NULL;
+    return alarm;
+}
+
+/* Return a fired or deleted alarm to the pool. It keeps its id until reused */
+static void
+alarm_put(alarm_t alarm)
+{
+    alarm->next = alarm_free;
+    alarm_free = alarm;
 }
 
 /* Initialize alarm structure */
@@ -97,6 +219,8 @@ alarm_initialize()
 {
     if ((alarm_clock = alarm_queue_new()) == NULL)
         return -1;
+    if (alarm_pool_grow() == -1)
+        return -1;
     alarm_time = -1;
     return 0;
 }
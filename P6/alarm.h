@@ -7,20 +7,49 @@
  */
 typedef struct alarm* alarm_t;
 
-/* Nearest alarm ticks to fire */
+/*
+ * Time sources of alarms:
+ *	ALARM_SOURCE_TICKS: ticks, the processor time clock that also
+ *	measures the scheduling quanta. The default.
+ *	ALARM_SOURCE_WALL: the monotonic wall clock, which keeps running
+ *	while the system is blocked, so timeouts hold under light load.
+ */
+typedef enum {
+    ALARM_SOURCE_TICKS,
+    ALARM_SOURCE_WALL
+} alarm_source_t;
+
+/*
+ * Time source of alarms and timeouts. Set it in the linked main program
+ * before initialization.
+ */
+extern alarm_source_t alarm_source;
+
+/* Nearest alarm time to fire, on the alarm time source */
 extern long alarm_time;
 
-/* The id of the alarm to be fired next */
-extern int next_alarm_id;
+/* Number of alarms registered so far */
+extern long next_alarm_id;
 
-/* register an alarm to go off in "delay" milliseconds, call func(arg) */
-extern int register_alarm(int delay, void (*func)(void*), void *arg);
+/*
+ * register an alarm to go off in "delay" milliseconds, call func(arg)
+ * Return the alarm id, which is never negative, or -1 on failure
+ */
+extern long register_alarm(int delay, void (*func)(void*), void *arg);
 
-extern void deregister_alarm(int alarmid);
+/*
+ * Delete the alarm with id alarmid in constant time. It is fine if it
+ * has already fired or been deleted.
+ */
+extern void deregister_alarm(long alarmid);
 
 /* Create an alarm structure */
 extern alarm_t alarm_create(int delay, void (*func)(void*), void *arg);
 
+/* Current time in milliseconds on the alarm time source */
+extern long alarm_now();
+
+/* Fire the alarms that are due and arm the clock for the next one */
 extern void alarm_signal();
 
 extern int alarm_initialize();
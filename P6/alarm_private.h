@@ -2,10 +2,23 @@
 #ifndef __ALARM_PRIVATE_H__
 #define __ALARM_PRIVATE_H__
 
+/*
+ * Bits of an alarm id holding its slot in the alarm table, and so the most
+ * alarms registered at a time. The bits above count registrations, 43 of
+ * them in a long, so a stale id does not match a later alarm reusing the
+ * slot.
+ */
+#define ALARM_SLOT_BITS 20
+#define ALARM_SLOTS_MAX (1 << ALARM_SLOT_BITS)
+
+/* Alarms preallocated in the pool by alarm_initialize */
+#define ALARM_POOL_INIT 256
+
 struct alarm {
 	struct alarm *prev;
 	struct alarm *next;
-	int alarm_id;
+	long alarm_id;
+	int bucket;             /* Wheel list holding the alarm, -1 if none */
 	long time_to_fire;
 	void (*func)(void*);
 	void *arg;
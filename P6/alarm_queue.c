@@ -2,10 +2,18 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "alarm_queue.h"
 #include "alarm_queue_private.h"
 #include "alarm_private.h"
 
+/* Bits of time covered by one slot of a level, and by the whole level */
+#define LEVEL_SHIFT(k) ((k) * ALARM_WHEEL_BITS)
+#define LEVEL_SPAN(k) LEVEL_SHIFT((k) + 1)
+
+static void alarm_queue_place(alarm_queue_t alarm_queue, alarm_t alarm);
+static void alarm_queue_cascade(alarm_queue_t alarm_queue);
+
 /*
  * Create a new alarm_queue
  * Return NULL on failure, pointer to queue on success
@@ -17,90 +25,144 @@ alarm_queue_new()
     if (new_queue == NULL) {
         return NULL;
     }
-    new_queue->head = NULL;
-    new_queue->tail = NULL;
-    new_queue->length = 0;
+    memset(new_queue, 0, sizeof(struct alarm_queue));
 
     return new_queue;
 }
 
 /*
  * Insert an alarm into alarm queue
- * The queue should be sorted by fire time
  * Return 0 on success, -1 on failure
  */
 int
 alarm_queue_insert(alarm_queue_t alarm_queue, alarm_t alarm)
 {
-    alarm_t cur;
     if (alarm_queue == NULL || alarm == NULL) {
         return -1;
     }
+    alarm_queue_place(alarm_queue, alarm);
+    alarm_queue->length += 1;
+    return 0;
+}
 
-    /* Empty queue */
-    if (alarm_queue->head == NULL && alarm_queue->tail == NULL) {
-        alarm_queue->head = alarm;
-        alarm_queue->tail = alarm;
-        alarm_queue->length += 1;
-        alarm->prev = NULL;
-        alarm->next = NULL;
-        return 0;
-    }
-
-    /* Find the insertion point */
-    for (cur = alarm_queue->head; cur != NULL
-            && cur->time_to_fire < alarm->time_to_fire; cur = cur->next);
+/*
+ * Link an alarm into the slot of the lowest level whose span around now
+ * holds its fire time. Alarms already due go to the slot of now.
+ */
+static void
+alarm_queue_place(alarm_queue_t alarm_queue, alarm_t alarm)
+{
+    long now = alarm_queue->now;
+    long t = alarm->time_to_fire;
+    int k;
+    int b;
 
-    /* Insert before head */
-    if (cur == alarm_queue->head) {
-        alarm->prev = NULL;
-        alarm->next = cur;
-        alarm_queue->head->prev = alarm;
-        alarm_queue->head = alarm;
-        alarm_queue->length += 1;
-        return 0;
+    if (t < now) {
+        t = now;
+    }
+    for (k = 0; k < ALARM_WHEEL_LEVELS; k++) {
+        if ((t >> LEVEL_SPAN(k)) == (now >> LEVEL_SPAN(k))) {
+            break;
+        }
+    }
+    if (k == ALARM_WHEEL_LEVELS) {
+        b = ALARM_OVERFLOW;
+    } else {
+        b = k * ALARM_WHEEL_SIZE
+            + ((t >> LEVEL_SHIFT(k)) & (ALARM_WHEEL_SIZE - 1));
+        alarm_queue->occupied[k] |= (uint64_t) 1 << (b % ALARM_WHEEL_SIZE);
     }
 
-    /* Insert after tail */
-    if (cur == NULL) {
-        alarm->prev = alarm_queue->tail;
-        alarm->next = NULL;
-        alarm_queue->tail->next = alarm;
-        alarm_queue->tail = alarm;
-        alarm_queue->length += 1;
-        return 0;
+    alarm->bucket = b;
+    alarm->prev = NULL;
+    alarm->next = alarm_queue->bucket[b];
+    if (alarm->next != NULL) {
+        alarm->next->prev = alarm;
     }
+    alarm_queue->bucket[b] = alarm;
+}
 
-    /* Insert in middle */
-    alarm->prev = cur->prev;
-    alarm->next = cur;
-    cur->prev->next = alarm;
-    cur->prev = alarm;
-    alarm_queue->length += 1;
-    return 0;
+/*
+ * Move the slots that now has reached down the wheel, and the overflow
+ * list when now enters a new span of the top level.
+ */
+static void
+alarm_queue_cascade(alarm_queue_t alarm_queue)
+{
+    long now = alarm_queue->now;
+    alarm_t alarm;
+    alarm_t next;
+    int k;
+    int b;
+
+    for (k = ALARM_WHEEL_LEVELS; k > 0; k--) {
+        if ((now & ((1L << LEVEL_SHIFT(k)) - 1)) != 0) {
+            continue;
+        }
+        if (k == ALARM_WHEEL_LEVELS) {
+            b = ALARM_OVERFLOW;
+        } else {
+            b = k * ALARM_WHEEL_SIZE
+                + ((now >> LEVEL_SHIFT(k)) & (ALARM_WHEEL_SIZE - 1));
+            alarm_queue->occupied[k] &= ~((uint64_t) 1 << (b % ALARM_WHEEL_SIZE));
+        }
+        alarm = alarm_queue->bucket[b];
+        alarm_queue->bucket[b] = NULL;
+        for (; alarm != NULL; alarm = next) {
+            next = alarm->next;
+            alarm_queue_place(alarm_queue, alarm);
+        }
+    }
 }
 
 /*
- * Dequeue an alarm from alarm queue head,
- * Return 0 on success, -1 on failure
+ * Remove every alarm due at or before time from alarm queue, advancing
+ * the wheel to time. Due slots of level 0 are detached whole and appended
+ * to the batch. Return the number of alarms removed
  */
 int
-alarm_queue_dequeue(alarm_queue_t alarm_queue, alarm_t *data)
+alarm_queue_expire(alarm_queue_t alarm_queue, long time, alarm_t *data)
 {
-    if (data == NULL) {
-        return -1;
-    }
-    if (alarm_queue == NULL) {
-        *data = NULL;
-        return -1;
+    alarm_t tail = NULL;
+    alarm_t alarm;
+    long next;
+    int count = 0;
+    int s;
+    if (alarm_queue == NULL || data == NULL) {
+        return 0;
     }
 
-    *data = alarm_queue->head;
-    if (*data == NULL) {
-        return -1;
+    *data = NULL;
+    while ((next = alarm_getnext(alarm_queue)) != -1 && next <= time) {
+        if (next > alarm_queue->now) {
+            alarm_queue->now = next;
+            alarm_queue_cascade(alarm_queue);
+        }
+        /* The earliest slot of level 0 holds alarms due exactly now */
+        s = alarm_queue->now & (ALARM_WHEEL_SIZE - 1);
+        if ((alarm_queue->occupied[0] & ((uint64_t) 1 << s)) == 0) {
+            continue;
+        }
+        alarm_queue->occupied[0] &= ~((uint64_t) 1 << s);
+        alarm = alarm_queue->bucket[s];
+        alarm_queue->bucket[s] = NULL;
+        if (tail == NULL) {
+            *data = alarm;
+        } else {
+            tail->next = alarm;
+            alarm->prev = tail;
+        }
+        for (; alarm != NULL; alarm = alarm->next) {
+            alarm->bucket = -1;
+            tail = alarm;
+            count++;
+        }
     }
-
-    return alarm_queue_delete(alarm_queue, data);
+    if (time > alarm_queue->now) {
+        alarm_queue->now = time;
+    }
+    alarm_queue->length -= count;
+    return count;
 }
 
 /*
@@ -111,20 +173,21 @@ int
 alarm_queue_delete(alarm_queue_t alarm_queue, alarm_t *data)
 {
     alarm_t alarm;
-    if (alarm_queue == NULL || data == NULL || *data == NULL) {
+    int b;
+    if (alarm_queue == NULL || data == NULL || *data == NULL
+            || (*data)->bucket < 0) {
         return -1;
     }
 
     alarm = *data;
-    /* Head */
-    if (alarm == alarm_queue->head) {
-        alarm_queue->head = alarm->next;
-    }
-    /* Tail */
-    if (alarm == alarm_queue->tail) {
-        alarm_queue->tail = alarm->prev;
+    b = alarm->bucket;
+    if (alarm == alarm_queue->bucket[b]) {
+        alarm_queue->bucket[b] = alarm->next;
+        if (alarm->next == NULL && b < ALARM_OVERFLOW) {
+            alarm_queue->occupied[b / ALARM_WHEEL_SIZE] &=
+                ~((uint64_t) 1 << (b % ALARM_WHEEL_SIZE));
+        }
     }
-
     if (alarm->prev != NULL) {
         alarm->prev->next = alarm->next;
     }
@@ -133,39 +196,34 @@ alarm_queue_delete(alarm_queue_t alarm_queue, alarm_t *data)
     }
     alarm->prev = NULL;
     alarm->next = NULL;
+    alarm->bucket = -1;
     alarm_queue->length--;
 
     return 0;
 }
 
 /*
- * Delete an alarm from alarm queue based on its alarm id
- * Return 0 on success, -1 on failure
- */
-int
-alarm_queue_delete_by_id(alarm_queue_t alarm_queue, int alarm_id, alarm_t *data)
-{
-    alarm_t alarm;
-    if (alarm_queue == NULL || data == NULL) {
-        return -1;
-    }
-    /* Find alarm with alarm_id */
-    for (alarm = alarm_queue->head; alarm != NULL
-            && alarm->alarm_id != alarm_id; alarm = alarm->next);
-    /* Delete the alarm from the queue. Let the caller manage memory */
-    *data = alarm;
-    return alarm_queue_delete(alarm_queue, data);
-}
-
-/*
- * Return lastest wake up time
+ * Return the start of the earliest non-empty slot, on the lowest level
+ * that has one. Slots of a level come after every slot of the levels
+ * below, and on level 0 the start is the fire time.
  * Return -1 if queue is empty
  */
 long
 alarm_getnext(alarm_queue_t alarm_queue)
 {
-    if (alarm_queue->head != NULL) {
-        return alarm_queue->head->time_to_fire;
+    long now = alarm_queue->now;
+    int k;
+
+    for (k = 0; k < ALARM_WHEEL_LEVELS; k++) {
+        if (alarm_queue->occupied[k] != 0) {
+            return ((now >> LEVEL_SPAN(k)) << LEVEL_SPAN(k))
+                   | ((long) __builtin_ctzll(alarm_queue->occupied[k])
+                      << LEVEL_SHIFT(k));
+        }
+    }
+    if (alarm_queue->bucket[ALARM_OVERFLOW] != NULL) {
+        k = ALARM_WHEEL_LEVELS - 1;
+        return ((now >> LEVEL_SPAN(k)) + 1) << LEVEL_SPAN(k);
     }
     return -1;
 }
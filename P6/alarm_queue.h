@@ -14,31 +14,26 @@ extern alarm_queue_t alarm_queue_new();
 
 /*
  * Insert an alarm into alarm queue
- * The queue should be sorted by fire time
  * Return 0 on success, -1 on failure
  */
 extern int alarm_queue_insert(alarm_queue_t, alarm_t);
 
 /*
- * Dequeue an alarm from alarm queue
- * Return 0 on success, -1 on failure
+ * Remove every alarm due at or before time from alarm queue, in one batch
+ * linked through their next fields in order of fire time
+ * Return the number of alarms removed
  */
-extern int alarm_queue_dequeue(alarm_queue_t, alarm_t*);
+extern int alarm_queue_expire(alarm_queue_t, long, alarm_t*);
 
 /*
- * Delete an alarm from alarm queue
+ * Delete an alarm from alarm queue in constant time
  * Return 0 on success, -1 on failure
  */
 extern int alarm_queue_delete(alarm_queue_t, alarm_t*);
 
 /*
- * Delete an alarm from alarm queue based on its alarm id
- * Return 0 on success, -1 on failure
- */
-extern int alarm_queue_delete_by_id(alarm_queue_t, int, alarm_t*);
-
-/*
- * Return lastest wake up time
+ * Return a time at or before the earliest alarm, when alarm_queue_expire
+ * should be called next. It is exact unless the earliest alarm is far off.
  * Return -1 if queue is empty
  */
 extern long alarm_getnext(alarm_queue_t);
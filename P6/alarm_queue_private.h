@@ -1,11 +1,26 @@
 /* alarm_queue_private.h: alarm queue structure */
-#ifndef __ALARM_QUEUE_PRIVATE_H__
+#ifndef __ALARM_QUEUE_PRIVATE_H__
 #define __ALARM_QUEUE_PRIVATE_H__
 
+#include <stdint.h>
+
+/*
+ * The alarm queue is a hierarchical timing wheel. Level k has
+ * ALARM_WHEEL_SIZE slots of 2^(k * ALARM_WHEEL_BITS) milliseconds each,
+ * and holds the alarms due in the same slot of level k + 1 as now but not
+ * in the same slot of level k - 1. Alarms beyond the last level wait in
+ * an overflow list. A slot is moved down a level when now reaches it.
+ */
+#define ALARM_WHEEL_BITS 6
+#define ALARM_WHEEL_SIZE (1 << ALARM_WHEEL_BITS)
+#define ALARM_WHEEL_LEVELS 4
+#define ALARM_OVERFLOW (ALARM_WHEEL_LEVELS * ALARM_WHEEL_SIZE)
+
 struct alarm_queue {
-	alarm_t head;
-	alarm_t tail;
+	long now;                                   /* Time the wheel is at */
 	int length;
-};
-
-#endif /* __ALARM_QUEUE_PRIVATE_H__ */
+	uint64_t occupied[ALARM_WHEEL_LEVELS];      /* Non-empty slots by level */
+	alarm_t bucket[ALARM_OVERFLOW + 1];         /* Slots, then overflow */
+};
+
+#endif /* __ALARM_QUEUE_PRIVATE_H__ */
@@ -18,7 +18,8 @@ double reordering_rate = 0.0;
    to 0, specify the disk_name, disk_flags and disk_size, then call disk_initialize().
    To startup an existing disk, set use_existing_disk to 1 and specify the disk_name,
    then call disk_initialize. Upon successful startup, disk_flags and disk_size will
-   be correctly initialized.
+   be correctly initialized. Set disk_name to NULL before minithread_system_initialize()
+   to run without a disk or file system.
  */
 
 /* Set to 1 if using an existing disk, 0 to create a new one */
@@ -34,6 +35,12 @@ void start_disk_poll(disk_t* disk); /* forward declaration */
 
 int disk_send_request(disk_t* disk, int blocknum, char* buffer,
                       disk_request_type_t type)
+{
+    return disk_send_request_token(disk, blocknum, buffer, type, NULL);
+}
+
+int disk_send_request_token(disk_t* disk, int blocknum, char* buffer,
+                            disk_request_type_t type, void* token)
 {
     disk_queue_elem_t* saved_last=NULL;
     disk_queue_elem_t* disk_request
@@ -46,6 +53,7 @@ int disk_send_request(disk_t* disk, int blocknum, char* buffer,
     disk_request->request.blocknum = blocknum;
     disk_request->request.buffer = buffer;
     disk_request->request.type = type;
+    disk_request->request.token = token;
 
     /* queue the request */
     pthread_mutex_lock(&disk_mutex);
@@ -27,7 +27,8 @@ extern double reordering_rate;
    to 0, specify the disk_name, disk_flags and disk_size, then call disk_initialize().
    To startup an existing disk, set use_existing_disk to 1 and specify the disk_name,
    then call disk_initialize. Upon successful startup, disk_flags and disk_size will
-   be correctly initialized.
+   be correctly initialized. Set disk_name to NULL before minithread_system_initialize()
+   to run without a disk or file system.
  */
 extern int use_existing_disk;	/* Set to 1 if using an existing disk, 0 to create a new one */
 extern const char* disk_name;	/* Linux filename that stores your virtual disk */
@@ -65,6 +66,7 @@ typedef struct {
     int blocknum;
     char* buffer; /* pointer to the memory buffer */
     disk_request_type_t type; /* type of disk request */
+    void* token; /* identifies the request to the interrupt handler */
 } disk_request_t;
 
 typedef struct disk_queue_elem_t {
@@ -100,6 +102,10 @@ disk_initialize(disk_t* disk);
 int
 disk_send_request(disk_t*, int, char*,disk_request_type_t);
 
+/* Like disk_send_request, with a token returned in the reply's request */
+int
+disk_send_request_token(disk_t*, int, char*, disk_request_type_t, void*);
+
 int
 disk_shutdown(disk_t* disk);
 
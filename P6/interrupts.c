@@ -1,11 +1,13 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/select.h>
 #include <signal.h>
 #include <fcntl.h>
 #include <pthread.h>
 #include <ucontext.h>
 #include <semaphore.h>
+#include <sched.h>
 #include "defs.h"
 #include "interrupts_private.h"
 #include "minithread.h"
@@ -17,12 +19,37 @@
 #define READ_INTERRUPT_TYPE 3
 #define NETWORK_INTERRUPT_TYPE 2
 #define CLOCK_INTERRUPT_TYPE 1
+#define NO_INTERRUPT_TYPE 0     /* Not recorded in the statistics */
+#define INTERRUPT_TYPES 5
 #define MAXBUF 1000
 #define ENABLED 1
 #define DISABLED 0
 
 interrupt_level_t interrupt_level;
 long ticks;
+int interrupt_mode = INTERRUPT_DEFER;
+int interrupt_time_disabled = 0;
+
+/* One-shot clock timer, on the processor time of the host thread */
+static timer_t clock_timer;
+/* Deadline in ticks the clock is armed for, -1 if it is not armed */
+static volatile long clock_armed = -1;
+/* Milliseconds to add to the processor time to get ticks */
+static long clock_offset;
+
+/* One-shot alarm timer, on the monotonic wall clock */
+static timer_t wall_timer;
+/* Wall time in ms the alarm timer is armed for, -1 if it is not armed */
+static volatile long wall_armed = -1;
+/* Monotonic time in ms when the clock was initialized */
+static long wall_epoch;
+
+/* One-shot timer replaying deferred interrupts, and whether it is armed */
+static timer_t kick_timer;
+static volatile int kick_armed = 0;
+
+/* Set while interrupt_replay runs handlers, which replays any queued meanwhile */
+static volatile int replaying = 0;
 extern int start();
 extern int end();
 
@@ -37,10 +64,45 @@ typedef struct interrupt_t interrupt_t;
 struct interrupt_t {
   interrupt_handler_t handler;
   void *arg;
+  int type;
+  uint64_t posted;              /* Time the device sent it, in ns */
+};
+
+/* Counters and histogram of a duration, see interrupt_stats */
+typedef struct interrupt_stat interrupt_stat_t;
+struct interrupt_stat {
+  unsigned long count;
+  uint64_t total;
+  uint64_t max;
+  unsigned long hist[INTERRUPT_HIST_BUCKETS];
 };
 
 static pthread_mutex_t signal_mutex;
 
+static void interrupt_deliver(int type, interrupt_handler_t handler, void* arg);
+static void interrupt_replay(void* arg);
+static void clock_program(timer_t timer, long delay);
+
+/*
+ * Device interrupts deferred because they arrived while interrupts were
+ * disabled. handle_interrupt is the only producer and the minithreads
+ * the only consumer, on the same host thread.
+ */
+static interrupt_t deferred[INTERRUPT_DEFERRED_SIZE];
+static volatile unsigned long deferred_head = 0;    /* Next entry to replay */
+static volatile unsigned long deferred_tail = 0;    /* Next entry to fill */
+
+/*
+ * Interrupt statistics, in ns. Latency runs from the device sending an
+ * interrupt to its handler being called, handler time from then until
+ * the handler returns. disabled_stat covers the sections with interrupts
+ * disabled; disabled_since is 0 when no section is being timed.
+ */
+static interrupt_stat_t latency_stat[INTERRUPT_TYPES];
+static interrupt_stat_t handler_stat[INTERRUPT_TYPES];
+static interrupt_stat_t disabled_stat;
+static uint64_t disabled_since = 0;
+
 #define R8 0
 #define R9 1
 #define R10 2
@@ -69,14 +131,126 @@ interrupt_handler_t mini_disk_handler;
 
 static volatile int signal_handled = 0;
 
+/* Set when a device signal was dropped, until one is taken */
+static volatile int interrupt_dropped = 0;
+
 sem_t interrupt_received_sema;
 
+/* Monotonic time in ns, for the statistics */
+static uint64_t interrupt_clock(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Add a duration of ns nanoseconds to stat */
+static void stat_record(interrupt_stat_t *stat, uint64_t ns){
+    uint64_t us = ns / 1000;
+    int bucket = (us == 0) ? 0 : 64 - __builtin_clzll(us);
+    if (bucket >= INTERRUPT_HIST_BUCKETS)
+        bucket = INTERRUPT_HIST_BUCKETS - 1;
+    ++stat->count;
+    stat->total += ns;
+    if (ns > stat->max)
+        stat->max = ns;
+    ++stat->hist[bucket];
+}
+
+/* End the section with interrupts disabled being timed, if any */
+void interrupt_disabled_end(){
+    if (disabled_since != 0)
+        stat_record(&disabled_stat, interrupt_clock() - disabled_since);
+    disabled_since = 0;
+}
+
 /*
  * atomically sets interrupt level and returns the original
- * interrupt level
+ * interrupt level. Enabling interrupts replays the deferred ones.
  */
 interrupt_level_t set_interrupt_level(interrupt_level_t newlevel) {
-    return swap(&interrupt_level, newlevel);
+    interrupt_level_t oldlevel;
+    if (newlevel == ENABLED && interrupt_level == DISABLED)
+        interrupt_disabled_end();
+    oldlevel = swap(&interrupt_level, newlevel);
+    if (oldlevel == ENABLED && newlevel == DISABLED && interrupt_time_disabled)
+        disabled_since = interrupt_clock();
+    if (newlevel == ENABLED && deferred_head != deferred_tail && !replaying)
+        interrupt_replay(NULL);
+    return oldlevel;
+}
+
+/* Call the handler of interrupt, timing it. Interrupts are disabled. */
+static void interrupt_run(interrupt_t *interrupt){
+    uint64_t entry;
+    if (interrupt->type == NO_INTERRUPT_TYPE){
+        interrupt->handler(interrupt->arg);
+        return;
+    }
+    entry = interrupt_clock();
+    stat_record(&latency_stat[interrupt->type], entry - interrupt->posted);
+    interrupt->handler(interrupt->arg);
+    set_interrupt_level(DISABLED);
+    stat_record(&handler_stat[interrupt->type], interrupt_clock() - entry);
+}
+
+/*
+ * Run the handlers of the queued interrupts in order of arrival, with
+ * interrupts disabled as if each had been taken, then enable interrupts.
+ * Interrupts queued meanwhile are run too. A handler enabling interrupts
+ * and taking another one does not nest a second replay: the queued
+ * interrupt is left to this one, which keeps the stack bounded.
+ */
+static void interrupt_replay(void* arg){
+    interrupt_t interrupt;
+    unsigned long head;
+    set_interrupt_level(DISABLED);
+    if (replaying){
+        interrupt_level = ENABLED;
+        return;
+    }
+    replaying = 1;
+    while ((head = deferred_head) != __atomic_load_n(&deferred_tail, __ATOMIC_ACQUIRE)){
+        interrupt = deferred[head & (INTERRUPT_DEFERRED_SIZE - 1)];
+        __atomic_store_n(&deferred_head, head + 1, __ATOMIC_RELEASE);
+        interrupt_run(&interrupt);
+    }
+    replaying = 0;
+    interrupt_disabled_end();
+    interrupt_level = ENABLED;
+}
+
+/*
+ * Replay the deferred interrupts if interrupts are enabled. Called after
+ * minithread_switch, which enables interrupts without set_interrupt_level.
+ */
+void interrupt_replay_deferred(){
+    if (interrupt_level == ENABLED && deferred_head != deferred_tail && !replaying)
+        interrupt_replay(NULL);
+}
+
+/*
+ * Queue a device interrupt from the signal handler, to be run by
+ * interrupt_replay. Return 0 if the queue is full.
+ */
+static int interrupt_enqueue(interrupt_t *interrupt){
+    unsigned long tail = deferred_tail;
+    if (tail - deferred_head == INTERRUPT_DEFERRED_SIZE)
+        return 0;
+    deferred[tail & (INTERRUPT_DEFERRED_SIZE - 1)] = *interrupt;
+    __atomic_store_n(&deferred_tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/*
+ * Arm the kick timer after deferring an interrupt, so it is replayed
+ * shortly even if nothing enables interrupts next, as when the signal
+ * landed outside the minithreads code while they were enabled.
+ */
+static void interrupt_kick(){
+    if (!kick_armed){
+        kick_armed = 1;
+        clock_program(kick_timer, 1);
+    }
 }
 
 
@@ -94,9 +268,7 @@ interrupt_level_t set_interrupt_level(interrupt_level_t newlevel) {
  */
 void
 minithread_clock_init(interrupt_handler_t clock_handler){
-    timer_t timerid;
     struct sigevent sev;
-    struct itimerspec its;
     //long long freq_nanosecs;
     //sigset_t mask;
     struct sigaction sa;
@@ -134,20 +306,122 @@ minithread_clock_init(interrupt_handler_t clock_handler){
     /* Create the timer */
     sev.sigev_notify = SIGEV_SIGNAL;
     sev.sigev_signo = SIGRTMAX-1;
-    sev.sigev_value.sival_ptr = &timerid;
-    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &timerid) == -1)
+    sev.sigev_value.sival_ptr = &clock_timer;
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &clock_timer) == -1)
+        errExit("timer_create");
+    sev.sigev_value.sival_ptr = &wall_timer;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &wall_timer) == -1)
+        errExit("timer_create");
+    sev.sigev_value.sival_ptr = &kick_timer;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &kick_timer) == -1)
         errExit("timer_create");
 
-    /* Start the timer */
-    its.it_value.tv_sec = (PERIOD) / 1000000000;
-    its.it_value.tv_nsec = (PERIOD) % 1000000000;
-    its.it_interval.tv_sec = its.it_value.tv_sec;
-    its.it_interval.tv_nsec = its.it_value.tv_nsec;
+    /* The timers are started by minithread_clock_arm and minithread_wall_arm */
+    clock_armed = -1;
+    clock_offset = 0;
+    wall_armed = -1;
+    wall_epoch = 0;
+    wall_epoch = minithread_wall_now();
+}
+
+/* Processor time of the host thread in milliseconds */
+static long
+clock_cputime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
 
-    if (timer_settime(timerid, 0, &its, NULL) == -1)
+/* Program timer to interrupt after delay ms on its clock */
+static void
+clock_program(timer_t timer, long delay)
+{
+    struct itimerspec its;
+    its.it_value.tv_sec = delay / 1000;
+    its.it_value.tv_nsec = (delay % 1000) * 1000000;
+    its.it_interval.tv_sec = 0;
+    its.it_interval.tv_nsec = 0;
+    if (timer_settime(timer, 0, &its, NULL) == -1)
         errExit("timer_settime");
 }
 
+/*
+ * Bring ticks up to date with the clock and return it.
+ */
+long
+minithread_clock_now()
+{
+    ticks = clock_cputime() + clock_offset;
+    return ticks;
+}
+
+/*
+ * Advance ticks by ms milliseconds that the host spent without running,
+ * and so without using processor time. The armed deadline is moved
+ * closer by as much.
+ */
+void
+minithread_clock_advance(long ms)
+{
+    clock_offset += ms;
+    minithread_clock_now();
+    if (clock_armed != -1)
+        clock_program(clock_timer, clock_armed > ticks ? clock_armed - ticks : 1);
+}
+
+/*
+ * Arm the clock to interrupt when ticks reaches deadline, unless it is
+ * already armed to interrupt earlier. A deadline of -1 is ignored.
+ * The common case of an earlier deadline does not read the clock.
+ */
+void
+minithread_clock_arm(long deadline)
+{
+    long delay;
+    if (deadline < 0)
+        return;
+    if (clock_armed != -1 && clock_armed <= deadline)
+        return;
+    delay = deadline - clock_cputime() - clock_offset;
+    if (delay < 1)
+        delay = 1;
+    clock_armed = deadline;
+    clock_program(clock_timer, delay);
+}
+
+/*
+ * Return the milliseconds elapsed on the monotonic wall clock since the
+ * clock was initialized. Unlike ticks, it keeps running while the host is
+ * descheduled or blocked.
+ */
+long
+minithread_wall_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000 - wall_epoch;
+}
+
+/*
+ * Arm the alarm timer to interrupt when the wall clock reaches deadline,
+ * unless it is already armed to interrupt earlier. A deadline of -1 is
+ * ignored. The interrupt calls the clock handler.
+ */
+void
+minithread_wall_arm(long deadline)
+{
+    long delay;
+    if (deadline < 0)
+        return;
+    if (wall_armed != -1 && wall_armed <= deadline)
+        return;
+    delay = deadline - minithread_wall_now();
+    if (delay < 1)
+        delay = 1;
+    wall_armed = deadline;
+    clock_program(wall_timer, delay);
+}
 
 /*
  * This function handles a signal and invokes the specified interrupt
@@ -201,15 +475,34 @@ handle_interrupt(int sig, siginfo_t *si, ucontext_t *ucontext)
          * the stack.
          */
         if(sig==SIGRTMAX-2){
+            /*
+             * Device interrupts are run from the queue, behind any
+             * deferred ones. If it is full, the interrupt is resent.
+             */
+            if(interrupt_enqueue((interrupt_t*)si->si_value.sival_ptr)){
+                signal_handled = 1;
+                interrupt_dropped = 0;
+            }
+            ucontext->uc_mcontext.gregs[RSP]=(unsigned long)newsp;
+            ucontext->uc_mcontext.gregs[RIP]=(unsigned long)interrupt_replay;
+            ucontext->uc_mcontext.gregs[RDI]=(unsigned long)0;
+            set_interrupt_level(DISABLED);
+        }
+        else if(sig==SIGRTMAX-1 && si->si_value.sival_ptr==&kick_timer){
+            kick_armed = 0;
             ucontext->uc_mcontext.gregs[RSP]=(unsigned long)newsp;
-            ucontext->uc_mcontext.gregs[RIP]=(unsigned long)((interrupt_t*)si->si_value.sival_ptr)->handler;
-            ucontext->uc_mcontext.gregs[RDI]=(unsigned long)((interrupt_t*)si->si_value.sival_ptr)->arg;
+            ucontext->uc_mcontext.gregs[RIP]=(unsigned long)interrupt_replay;
+            ucontext->uc_mcontext.gregs[RDI]=(unsigned long)0;
             set_interrupt_level(DISABLED);
         }
         else if(sig==SIGRTMAX-1){
             ucontext->uc_mcontext.gregs[RSP]=(unsigned long)newsp;
             ucontext->uc_mcontext.gregs[RIP]=(unsigned long)mini_clock_handler;
             ucontext->uc_mcontext.gregs[RDI]=(unsigned long)0;
+            if(si->si_value.sival_ptr==&wall_timer)
+                wall_armed = -1;
+            else
+                clock_armed = -1;
             if(DEBUG)
                 printf("SP=%p\n",newsp);
         }
@@ -218,8 +511,32 @@ handle_interrupt(int sig, siginfo_t *si, ucontext_t *ucontext)
             fflush(stdout);
             abort();
         }
-        if(sig==SIGRTMAX-2)
+    }
+    else if(sig==SIGRTMAX-2){
+        /* Replayed when interrupts are enabled, or resent if dropped */
+        if(interrupt_mode==INTERRUPT_DEFER &&
+                interrupt_enqueue((interrupt_t*)si->si_value.sival_ptr)){
             signal_handled = 1;
+            interrupt_kick();
+        }
+        else
+            interrupt_dropped = 1;
+    }
+    else if(sig==SIGRTMAX-1){
+        /* The timers are one-shot, so a dropped tick is retried shortly */
+        if(si->si_value.sival_ptr==&kick_timer){
+            kick_armed = 0;
+            if(deferred_head != deferred_tail)
+                interrupt_kick();
+        }
+        else if(si->si_value.sival_ptr==&wall_timer){
+            wall_armed = 0;
+            clock_program(wall_timer, 1);
+        }
+        else {
+            clock_armed = ticks;
+            clock_program(clock_timer, 1);
+        }
     }
 
     if(sig==SIGRTMAX-2){
@@ -229,22 +546,36 @@ handle_interrupt(int sig, siginfo_t *si, ucontext_t *ucontext)
     }
 }
 
+/* Handler registered for a device interrupt type */
+static interrupt_handler_t interrupt_handler_of(int interrupt_type){
+    if(interrupt_type==NETWORK_INTERRUPT_TYPE)
+        return mini_network_handler;
+    else if(interrupt_type==READ_INTERRUPT_TYPE)
+        return mini_read_handler;
+    else if(interrupt_type==DISK_INTERRUPT_TYPE)
+        return mini_disk_handler;
+    abort();
+}
+
 void send_interrupt(int interrupt_type, interrupt_handler_t handler, void* arg){
+    interrupt_deliver(interrupt_type, interrupt_handler_of(interrupt_type), arg);
+}
+
+/*
+ * Run handler(arg) on the minithreads, resending the signal until it is
+ * taken or deferred, and return once it has been.
+ */
+static void interrupt_deliver(int type, interrupt_handler_t handler, void* arg){
 
     interrupt_t interrupt;
+    interrupt.type = type;
+    interrupt.posted = interrupt_clock();
     pthread_mutex_lock(&signal_mutex);
     for (;;){
         signal_handled = 0;
 
         interrupt.arg = arg;
-        if(interrupt_type==NETWORK_INTERRUPT_TYPE)
-            interrupt.handler = mini_network_handler;
-        else if(interrupt_type==READ_INTERRUPT_TYPE)
-            interrupt.handler = mini_read_handler;
-        else if(interrupt_type==DISK_INTERRUPT_TYPE)
-            interrupt.handler = mini_disk_handler;
-        else
-            abort();
+        interrupt.handler = handler;
 
         /* Repeat if signal is not delivered. */
         while(sigqueue(getpid(),SIGRTMAX-2, (union sigval)(void*)&interrupt)==-1);
@@ -261,3 +592,132 @@ void send_interrupt(int interrupt_type, interrupt_handler_t handler, void* arg){
     }
     pthread_mutex_unlock(&signal_mutex);
 }
+
+/*
+ * Block the host for up to timeout ms, or until a signal arrives if timeout
+ * is -1, unless a device interrupt is already deferred. Interrupts should
+ * be disabled, so the handlers only defer. The signals stay blocked from
+ * the check until pselect unblocks them atomically, so one sent meanwhile
+ * ends the wait instead of being slept through. A dropped interrupt, as in
+ * INTERRUPT_DROP mode, is resent until it is taken with interrupts enabled,
+ * so the host does not park again until then.
+ */
+void interrupt_park(long timeout){
+    sigset_t mask, oldmask;
+    struct timespec ts;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGRTMAX-1);
+    sigaddset(&mask, SIGRTMAX-2);
+    pthread_sigmask(SIG_BLOCK, &mask, &oldmask);
+    if (deferred_head == deferred_tail && !interrupt_dropped){
+        ts.tv_sec = timeout / 1000;
+        ts.tv_nsec = (timeout % 1000) * 1000000;
+        pselect(0, NULL, NULL, NULL, timeout < 0 ? NULL : &ts, &oldmask);
+    }
+    pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
+}
+
+/*
+ * Batched delivery. The network poller thread is the only producer of the
+ * ring and the interrupt handler on the minithreads the only consumer, so
+ * the ring needs no lock. ring_kicked is set while a drain is signaled or
+ * running; only the poller that sets it from 0 sends the signal, and
+ * packets queued meanwhile are picked up by the same drain.
+ */
+static interrupt_t ring[INTERRUPT_RING_SIZE];
+static volatile unsigned long ring_head = 0;     /* Next entry to drain */
+static volatile unsigned long ring_tail = 0;     /* Next entry to fill */
+static volatile int ring_kicked = 0;
+
+/* Run the handlers of every queued entry, until the ring stays empty */
+static void ring_drain(void* arg){
+    unsigned long head = ring_head;
+    interrupt_t *entry;
+    do {
+        while (head != __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE)) {
+            entry = &ring[head & (INTERRUPT_RING_SIZE - 1)];
+            interrupt_run(entry);
+            __atomic_store_n(&ring_head, ++head, __ATOMIC_RELEASE);
+        }
+        __atomic_store_n(&ring_kicked, 0, __ATOMIC_SEQ_CST);
+        /* An entry queued before the flag was cleared did not signal */
+    } while (head != __atomic_load_n(&ring_tail, __ATOMIC_SEQ_CST)
+             && __atomic_exchange_n(&ring_kicked, 1, __ATOMIC_SEQ_CST) == 0);
+}
+
+/* Signal a drain unless one is already signaled or running */
+static void ring_kick(){
+    if (__atomic_exchange_n(&ring_kicked, 1, __ATOMIC_SEQ_CST) == 0)
+        interrupt_deliver(NO_INTERRUPT_TYPE, ring_drain, NULL);
+}
+
+void send_interrupt_batched(int interrupt_type, void* arg){
+    unsigned long tail = ring_tail;
+    interrupt_t *entry;
+
+    /* Wait for the minithreads to make room */
+    while (tail - __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE)
+            == INTERRUPT_RING_SIZE) {
+        ring_kick();
+        sched_yield();
+    }
+    entry = &ring[tail & (INTERRUPT_RING_SIZE - 1)];
+    entry->handler = interrupt_handler_of(interrupt_type);
+    entry->arg = arg;
+    entry->type = interrupt_type;
+    entry->posted = interrupt_clock();
+    __atomic_store_n(&ring_tail, tail + 1, __ATOMIC_SEQ_CST);
+    ring_kick();
+}
+
+/* Print stat of a type of interrupt, with its nonempty buckets */
+static void stat_print(const char *name, const char *what, interrupt_stat_t *stat){
+    int i;
+    if (stat->count == 0)
+        return;
+    printf("%s %s: %lu, mean %lu us, max %lu us\n", name, what, stat->count,
+           (unsigned long)(stat->total / stat->count / 1000),
+           (unsigned long)(stat->max / 1000));
+    for (i = 0; i < INTERRUPT_HIST_BUCKETS; ++i) {
+        if (stat->hist[i] == 0)
+            continue;
+        if (i == INTERRUPT_HIST_BUCKETS - 1)
+            printf("  %8lu+     us %10lu\n", 1ul << (i - 1), stat->hist[i]);
+        else
+            printf("  %8lu-%-6lu us %10lu\n", i ? 1ul << (i - 1) : 0,
+                   1ul << i, stat->hist[i]);
+    }
+}
+
+void interrupt_stats(){
+    static const char *type_name[INTERRUPT_TYPES] = {
+        NULL, NULL, "network", "read", "disk"
+    };
+    interrupt_stat_t latency[INTERRUPT_TYPES];
+    interrupt_stat_t handler[INTERRUPT_TYPES];
+    interrupt_stat_t disabled;
+    interrupt_level_t oldlevel;
+    int type;
+
+    oldlevel = set_interrupt_level(DISABLED);
+    memcpy(latency, latency_stat, sizeof(latency));
+    memcpy(handler, handler_stat, sizeof(handler));
+    disabled = disabled_stat;
+    set_interrupt_level(oldlevel);
+
+    for (type = 0; type < INTERRUPT_TYPES; ++type) {
+        if (type_name[type] == NULL)
+            continue;
+        stat_print(type_name[type], "latency", &latency[type]);
+        stat_print(type_name[type], "handler", &handler[type]);
+    }
+    stat_print("interrupts", "disabled", &disabled);
+}
+
+void interrupt_stats_reset(){
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    memset(latency_stat, 0, sizeof(latency_stat));
+    memset(handler_stat, 0, sizeof(handler_stat));
+    memset(&disabled_stat, 0, sizeof(disabled_stat));
+    set_interrupt_level(oldlevel);
+}
@@ -18,12 +18,13 @@
  */
 
 /*
- * a global variable to maintain time.
+ * a global variable to maintain time, in milliseconds. It is brought up
+ * to date by minithread_clock_now.
  */
 extern long ticks;
 
 /*
- * period is the frequency of the clock tick.
+ * period is the length of a scheduling quantum.
  */
 #define MICROSECOND 1000
 #define MILLISECOND (1000*MICROSECOND)
@@ -41,6 +42,15 @@ extern interrupt_level_t interrupt_level;
 #define DISABLED 0
 #define ENABLED 1
 
+/*
+ * What becomes of a device interrupt that arrives while interrupts are
+ * disabled. With INTERRUPT_DEFER, the default, it is queued and its
+ * handler runs as soon as interrupts are enabled again, so the device
+ * does not wait. With INTERRUPT_DROP the device resends it until it is
+ * taken. Set it before minithread_system_initialize.
+ */
+extern int interrupt_mode;
+
 
 typedef void(*interrupt_handler_t)(void*);
 /*
@@ -74,13 +84,62 @@ typedef void(*interrupt_handler_t)(void*);
  * in order to reduce the impact on the real-time performance of your system.
  */
 extern interrupt_level_t set_interrupt_level(interrupt_level_t newlevel);
+/*
+ * Print statistics of the device interrupts: for each type, histograms
+ * of the latency from the device sending an interrupt to its handler
+ * being called, and of the time the handler ran. Also print a histogram
+ * of how long interrupts stayed disabled, with the longest time.
+ */
+extern void interrupt_stats();
+
+/*
+ * Clear the statistics printed by interrupt_stats.
+ */
+extern void interrupt_stats_reset();
+
+/*
+ * Whether the time interrupts stay disabled is measured, which costs a
+ * clock read on every disable and enable. Off by default.
+ */
+extern int interrupt_time_disabled;
+
 /*
  * minithread_clock_init installs your clock interrupt service routine
- * h.  h will be called every PERIOD microseconds (defined above).
+ * h.  The clock is one-shot: h will be called once ticks reaches the
+ * deadline set with minithread_clock_arm, and then not again until the
+ * clock is armed anew. h is also called when the wall clock reaches the
+ * deadline set with minithread_wall_arm.
  * interrupts are disabled after minithread_clock_init finishes.
- * After you enable interrupts then your handler will be called
- * automatically on every clock tick.
  */
 extern void minithread_clock_init(interrupt_handler_t h);
 
+/*
+ * Arm the clock to interrupt when ticks reaches deadline, unless it is
+ * already armed to interrupt earlier. A deadline of -1 is ignored.
+ */
+extern void minithread_clock_arm(long deadline);
+
+/*
+ * Bring ticks up to date with the clock and return it.
+ */
+extern long minithread_clock_now();
+
+/*
+ * Advance ticks by ms milliseconds that the system spent without running,
+ * such as while parked waiting for an interrupt.
+ */
+extern void minithread_clock_advance(long ms);
+
+/*
+ * Return the milliseconds elapsed on the monotonic wall clock since
+ * minithread_clock_init. It keeps running while the system is blocked.
+ */
+extern long minithread_wall_now();
+
+/*
+ * Arm the clock to interrupt when the wall clock reaches deadline, unless
+ * it is already armed to interrupt earlier. A deadline of -1 is ignored.
+ */
+extern void minithread_wall_arm(long deadline);
+
 #endif /* __INTERRUPTS_H_ */
@@ -42,4 +42,51 @@ mini_disk_handler;
 
 void send_interrupt(int interrupt_type, interrupt_handler_t handler, void* arg);
 
+/*
+ * Entries of the queue of deferred interrupts, a power of two. When it is
+ * full, further interrupts are dropped and resent as in INTERRUPT_DROP.
+ */
+#define INTERRUPT_DEFERRED_SIZE 64
+
+/*
+ * Buckets of the interrupt statistics histograms. Bucket 0 counts the
+ * durations under 1 us, bucket i those from 2^(i-1) to 2^i us, and the
+ * last one everything longer.
+ */
+#define INTERRUPT_HIST_BUCKETS 24
+
+/*
+ * End the section with interrupts disabled in the statistics. Called
+ * before minithread_switch, which enables interrupts itself, and before
+ * the idle loop parks the host with interrupts disabled.
+ */
+void interrupt_disabled_end();
+
+/*
+ * Park the host for up to timeout ms, -1 for no limit, until a signal
+ * arrives. Returns at once if a device interrupt is already deferred.
+ * Interrupts should be disabled.
+ */
+void interrupt_park(long timeout);
+
+/*
+ * Replay the deferred interrupts if interrupts are enabled. The scheduler
+ * calls it once minithread_switch, which enables interrupts without
+ * set_interrupt_level, has returned or started a new thread.
+ */
+void interrupt_replay_deferred();
+
+/*
+ * Entries of the ring of batched interrupts, a power of two.
+ */
+#define INTERRUPT_RING_SIZE 256
+
+/*
+ * Queue an interrupt of interrupt_type with arg for its handler, without
+ * waiting for it to be taken. A single signal runs the handlers of every
+ * interrupt queued before it is taken. Only one device thread may use it,
+ * the network poller.
+ */
+void send_interrupt_batched(int interrupt_type, void* arg);
+
 #endif
@@ -9,8 +9,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "defs.h"
+#include "interrupts.h"
 #include "machineprimitives.h"
 #include <sys/mman.h>
+#include <signal.h>
+#include <unistd.h>
 
 /*
  * Used to initialize a thread's stack for the first context switch
@@ -20,21 +23,12 @@
 typedef struct initial_stack_state *initial_stack_state_t;
 struct initial_stack_state 
 {
-  void *body_proc;            /* v1 or ebx */
-  void *body_arg;             /* v2 or edi */
-  void *finally_proc;         /* v3 or esi */
-  void *finally_arg;          /* v4 or ebp */
-  void *r8;
-  void *r9;
-  void *r10;
-  void *r11;
-  void *r12;
-  void *r13;
+  void *body_proc;            /* rbx */
+  void *finally_arg;          /* rbp */
+  void *body_arg;             /* r12 */
+  void *finally_proc;         /* r13 */
   void *r14;
   void *r15;
-  void *rax;
-  void *rcx;
-  void *rdx;
 #ifdef WINCE
   int   v5;
   int   v6;
@@ -45,36 +39,118 @@ struct initial_stack_state
 };
 
 #define STACK_GROWS_DOWN        1
-#define STACKSIZE               (256 * 1024)
+#define STACKSIZE               DEFAULT_STACKSIZE
 #define STACKALIGN              0xf
 
+/* Stack sizes are rounded up to a power of two, at least 2^STACK_MIN_SHIFT */
+#define STACK_MIN_SHIFT         14
+#define STACK_CLASSES           16
+/* Maximum number of free stacks kept in the pool for each size */
+#define STACK_POOL_MAX          64
+
+/*
+ * Free stacks are linked through their lowest usable word.
+ * The guard page below it cannot be written.
+ */
+typedef struct free_stack *free_stack_t;
+struct free_stack {
+    free_stack_t next;
+};
+
+static free_stack_t stack_pool[STACK_CLASSES];
+static int stack_pool_len[STACK_CLASSES];
+static long stack_pool_hits;
+static long stack_pool_misses;
+
+/*
+ * Bytes mapped above the top of a stack. When an interrupt is delivered
+ * the floating point state is copied just below the interrupted stack
+ * pointer, and sigreturn reads a full signal frame's worth of it.
+ */
+static size_t
+stack_headroom(size_t page)
+{
+    long min = sysconf(_SC_MINSIGSTKSZ);
+    if (min <= 0)
+        min = MINSIGSTKSZ;
+    return ((size_t) min + page - 1) & ~(page - 1);
+}
+
+/* Size class of a stack of size bytes, -1 if it is too large */
+static int
+stack_class(size_t size)
+{
+    int c;
+    for (c = 0; c < STACK_CLASSES; ++c) {
+        if (((size_t) 1 << (STACK_MIN_SHIFT + c)) >= size)
+            return c;
+    }
+    return -1;
+}
+
 /*
  * Allocate a new stack.
  */
 void
 minithread_allocate_stack(stack_pointer_t *stackbase, stack_pointer_t *stacktop)
 {
-    *stackbase = (stack_pointer_t) malloc(STACKSIZE);
-    if (!*stackbase)  {
-	return;
+    minithread_allocate_stack_size(stackbase, stacktop, STACKSIZE);
+}
+
+/*
+ * Allocate a stack of at least size bytes with a guard page below it,
+ * reusing a pooled stack of the same size class when there is one.
+ */
+void
+minithread_allocate_stack_size(stack_pointer_t *stackbase,
+                               stack_pointer_t *stacktop, size_t size)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t len;
+    free_stack_t fs = NULL;
+    interrupt_level_t oldlevel;
+    int c = stack_class(size);
+
+    *stackbase = NULL;
+    if (c < 0)
+        return;
+    size = (size_t) 1 << (STACK_MIN_SHIFT + c);
+    len = page + size + stack_headroom(page);
+
+    oldlevel = set_interrupt_level(DISABLED);
+    if (NULL != stack_pool[c]) {
+        fs = stack_pool[c];
+        stack_pool[c] = fs->next;
+        --stack_pool_len[c];
+        ++stack_pool_hits;
+    } else {
+        ++stack_pool_misses;
+    }
+    set_interrupt_level(oldlevel);
+
+    if (NULL != fs) {
+        *stackbase = (stack_pointer_t) ((char*) fs - page);
+    } else {
+        *stackbase = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == *stackbase) {
+            *stackbase = NULL;
+            return;
+        }
+        if (mprotect(*stackbase, page, PROT_NONE) != 0) {
+            munmap(*stackbase, len);
+            *stackbase = NULL;
+            return;
+        }
     }
 
     if (STACK_GROWS_DOWN)
-      /* Stacks grow down, but malloc grows up. Compensate and word align
-	 (turn off low 2 bits by anding with ~3). */
-      *stacktop = (stack_pointer_t) ((long)((char*)*stackbase + STACKSIZE - 1) & ~STACKALIGN);
+      /* Stacks grow down from the end of the mapping. Word align. */
+      *stacktop = (stack_pointer_t) ((long)((char*)*stackbase + page + size - 1) & ~STACKALIGN);
     else {
       /* Word align (turn off low 2 bits by anding with ~3) */
-      *stacktop = (stack_pointer_t)(((long)*stackbase + 3)&~STACKALIGN);
+      *stacktop = (stack_pointer_t)(((long)*stackbase + page + 3)&~STACKALIGN);
     }
-    /*
-    mprotect(*stackbase,0x100,PROT_NONE);
-    *stackbase =(stack_pointer_t)((long)((char*)*stackbase + 0x100));
-    *stacktop =(stack_pointer_t)((long)((char*)*stacktop - 0x100));
-    mprotect(*stacktop,0x100, PROT_READ | PROT_WRITE );
-    kprintf("Stack base is: %p\n",*stackbase);
-    kprintf("Stack top is : %p\n",*stacktop);
-    */
 }
 
 /* 
@@ -85,7 +161,46 @@ minithread_allocate_stack(stack_pointer_t *stackbase, stack_pointer_t *stacktop)
 void
 minithread_free_stack(stack_pointer_t stackbase)
 {
-    free(stackbase);
+    minithread_free_stack_size(stackbase, STACKSIZE);
+}
+
+/*
+ * Return a stack to the pool, or unmap it if the pool is full.
+ */
+void
+minithread_free_stack_size(stack_pointer_t stackbase, size_t size)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    free_stack_t fs;
+    interrupt_level_t oldlevel;
+    int c = stack_class(size);
+
+    if (NULL == stackbase || c < 0)
+        return;
+    size = (size_t) 1 << (STACK_MIN_SHIFT + c);
+    fs = (free_stack_t) ((char*) stackbase + page);
+
+    oldlevel = set_interrupt_level(DISABLED);
+    if (stack_pool_len[c] < STACK_POOL_MAX) {
+        fs->next = stack_pool[c];
+        stack_pool[c] = fs;
+        ++stack_pool_len[c];
+        fs = NULL;
+    }
+    set_interrupt_level(oldlevel);
+
+    if (NULL != fs)
+        munmap(stackbase, page + size + stack_headroom(page));
+}
+
+/* Get the number of stack pool hits and misses */
+void
+minithread_stack_pool_stats(long *hits, long *misses)
+{
+    if (NULL != hits)
+        *hits = stack_pool_hits;
+    if (NULL != misses)
+        *misses = stack_pool_misses;
 }
 
 /*
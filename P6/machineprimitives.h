@@ -15,6 +15,9 @@
 
 typedef void *stack_pointer_t;
 
+/* Size of a thread stack when none is specified */
+#define DEFAULT_STACKSIZE (256 * 1024)
+
 typedef int tas_lock_t;	      /* test-and-set locks.  */
 typedef int *arg_t;           /* function argument */
 typedef int (*proc_t)(arg_t); /* generic function pointer */
@@ -37,6 +40,28 @@ typedef int (*proc_t)(arg_t); /* generic function pointer */
 extern void minithread_allocate_stack(stack_pointer_t *stackbase,
 				      stack_pointer_t *stacktop);
 
+/*
+ * Like minithread_allocate_stack, with at least stacksize bytes of stack.
+ * The page below the stack is a guard page, so an overflow faults.
+ * Stacks are recycled through a pool, so the same stacksize must be
+ * passed to minithread_free_stack_size. *stackbase is NULL on failure.
+ */
+extern void minithread_allocate_stack_size(stack_pointer_t *stackbase,
+				      stack_pointer_t *stacktop,
+				      size_t stacksize);
+
+/*
+ * Return a stack from minithread_allocate_stack_size to the pool.
+ */
+extern void minithread_free_stack_size(stack_pointer_t stackbase,
+				      size_t stacksize);
+
+/*
+ * Get the number of stack allocations served from the pool (hits) and
+ * by mapping a new stack (misses).
+ */
+extern void minithread_stack_pool_stats(long *hits, long *misses);
+
 /*
  * minithread_free_stack(stack_pointer_t stackbase)
  *	Frees the stack at stackbase.  If the caller is running on the stack
@@ -71,8 +96,10 @@ extern void minithread_initialize_stack(stack_pointer_t *stacktop,
 /* 
  * Context switch primitive.
  *
- * This call will first save the caller's state (i.e. all of its registers)
- * on the stack.
+ * This call will first save the caller's callee-saved registers (rbx, rbp
+ * and r12-r15) on the stack. The other registers are already saved by the
+ * C caller, or by the interrupt trampoline when the switch happens inside
+ * an interrupt handler.
  * It will then save the stack pointer in the location pointed to 
  * by old_thread_sp. It will replace the processor's stack pointer 
  * with the value pointed to by the new_thread_sp. Finally, it will
@@ -10,6 +10,7 @@
 #include "minithread.h"
 
 static void minifile_cursor_shift(minifile_t file, int shift);
+static int minifile_readahead(minifile_t file, blocknum_t *ahead);
 
 minifile_t minifile_creat(char *filename)
 {
@@ -80,6 +81,9 @@ minifile_t minifile_creat(char *filename)
     file->byte_in_block = 0;
     file->mode[0] = 'w';
     file->mode[1] = '\0';
+    file->ra_next = 0;
+    file->ra_end = 0;
+    file->ra_window = 0;
     return file;
 }
 
@@ -133,6 +137,9 @@ minifile_t minifile_open(char *filename, char *mode)
     if ('+' == mode[1]) {
         file->mode[1] = '+';
     }
+    file->ra_next = file->block_cursor;
+    file->ra_end = file->block_cursor;
+    file->ra_window = 0;
 
     return file;
 }
@@ -144,6 +151,8 @@ int minifile_read(minifile_t file, char *data, int maxlen)
     int disk_block = 0;
     buf_block_t buf;
     int step = 0;
+    blocknum_t ahead[READAHEAD_MAX];
+    int nahead;
     if (('w' == file->mode[0] || 'a' == file->mode[0])
             && ('\0' == file->mode[1])) {
         return -1;
@@ -162,11 +171,12 @@ int minifile_read(minifile_t file, char *data, int maxlen)
             step = maxlen;
         }
         /* Get disk block number from block cursor */
-        ilock(file->inode);
+        ilock_shared(file->inode);
         disk_block = blockmap(maindisk, file->inode, file->block_cursor);
+        nahead = minifile_readahead(file, ahead);
         iunlock(file->inode);
         /* Copy disk block */
-        if (bread(maindisk, disk_block, &buf) != 0)
+        if (breada(maindisk, disk_block, ahead, nahead, &buf) != 0)
             return count;
         memcpy(data, buf->data + file->byte_in_block, step);
         brelse(buf);
@@ -230,6 +240,7 @@ int minifile_write(minifile_t file, char *data, int len)
         }
         /* Update upon success */
         minifile_cursor_shift(file, step);
+        data += step;
         len -= step;
         /* Update disk inode size */
         if (file->inode->size < file->byte_cursor) {
@@ -531,9 +542,9 @@ char **minifile_ls(char *path)
 		return entries;
 	}
 
-	semaphore_P(dir->inode_lock);
+	ilock_shared(dir);
 	dir_entries = get_directory_entry(maindisk, dir, &entries_size);
-	semaphore_V(dir->inode_lock);
+	iunlock(dir);
 
 	iput(dir);
 	entries = malloc((entries_size + 1) * sizeof(char*));
@@ -577,9 +588,9 @@ char* minifile_pwd(void)
 		if (iget(maindisk, parent_inodenum, &cur_directory) != 0) {
 			printf("Get inode error!\n");
 		}
-		semaphore_P(cur_directory->inode_lock);
+		ilock_shared(cur_directory);
 		entries = get_directory_entry(maindisk, cur_directory, &entry_size);
-		semaphore_V(cur_directory->inode_lock);
+		iunlock(cur_directory);
 		for (i = 0; i < entry_size; i++) {
 			if (entries[i]->inode_num == cur_inodenum) {
 				break;
@@ -611,6 +622,59 @@ char* minifile_pwd(void)
 	return pwd;
 }
 
+int minifile_sync(void)
+{
+    return bsync();
+}
+
+/*
+ * Track sequential reads of the block at the cursor, and store in ahead
+ * the disk blocks to read ahead, if any. Return their number. The
+ * caller holds the inode lock.
+ */
+static int
+minifile_readahead(minifile_t file, blocknum_t *ahead)
+{
+    int block = file->block_cursor;
+    int last = (file->inode->size - 1) / DISK_BLOCK_SIZE;
+    int end;
+    int n = 0;
+
+    if (block != file->ra_next && block != file->ra_next - 1) {
+        /* Random access */
+        file->ra_window = 0;
+        file->ra_next = block + 1;
+        file->ra_end = block + 1;
+        return 0;
+    }
+    if (block != file->ra_next) {
+        /* Rest of the block read last */
+        return 0;
+    }
+    file->ra_next = block + 1;
+    if (0 == file->ra_window) {
+        file->ra_window = READAHEAD_MIN;
+        file->ra_end = block + 1;
+    } else if (block + file->ra_window / 2 >= file->ra_end) {
+        if (file->ra_window < READAHEAD_MAX)
+            file->ra_window *= 2;
+    } else {
+        return 0;
+    }
+
+    end = block + 1 + file->ra_window;
+    if (end > last + 1)
+        end = last + 1;
+    if (file->ra_end < block + 1)
+        file->ra_end = block + 1;
+    for (; file->ra_end < end; ++file->ra_end) {
+        ahead[n] = blockmap(maindisk, file->inode, file->ra_end);
+        if (ahead[n] > 0)
+            ++n;
+    }
+    return n;
+}
+
 void
 minifile_cursor_shift(minifile_t file, int shift)
 {
@@ -112,5 +112,12 @@ char **minifile_ls(char *path);
  */
 char* minifile_pwd(void);
 
+/*
+ * Writes every modified block of the file system back to the disk,
+ * returning when the writes are done.
+ * Return: 0 if everything is fine or -1 if a write failed.
+ */
+int minifile_sync(void);
+
 
 #endif /* __MINIFILE_H__ */
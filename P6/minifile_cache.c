@@ -1,8 +1,12 @@
 #include "defs.h"
 
+#include <sys/mman.h>
+
+#include "alarm.h"
 #include "interrupts.h"
 #include "minifile.h"
 #include "minifile_cache.h"
+#include "minithread.h"
 
 
 /*********************************************************************
@@ -11,59 +15,107 @@
  *     Know the block num to use (from inode, or allocated by balloc).
  * (2) Use bread to get the block.
  * (3) Use bwrite/bdwrite/bawrite/brelse to return the block,
- *     and schedule/immediately write to disk.
+ *     and schedule/immediately write to disk. Blocks left dirty by
+ *     bdwrite are written back by the flusher thread, or by bsync.
  * (+) Before the block is returned, no other thread can use it.
+ *     Threads using different blocks do not wait for each other.
+ * (+) The cache holds a fixed number of blocks. When all of them are
+ *     in use, bread waits for one to be released.
  ********************************************************************/
 
+size_t buffer_cache_blocks = BUFFER_CACHE_BLOCKS;
+
 
 /* Functions on hash list */
 static buf_block_t hash_find(disk_t* disk, blocknum_t n, blocknum_t bhash);
 static void hash_add(buf_block_t block, blocknum_t bhash);
 static void hash_remove(buf_block_t block, blocknum_t bhash);
-static buf_block_t get_buf_block();
+static buf_block_t get_buf_block(int wait);
+static void put_buf_block(buf_block_t block);
+static void lru_append(buf_block_t block);
+static void lru_remove(buf_block_t block);
+static void io_sem_P(semaphore_t sem);
+static void io_sem_V(semaphore_t sem);
 static disk_reply_t blocking_read(buf_block_t buf);
-
-/* Initialize buffer cache */
+static disk_reply_t blocking_request(buf_block_t buf, disk_request_type_t type);
+static void block_grab(buf_block_t block);
+static void block_dirty(buf_block_t buf);
+static void block_clean(buf_block_t buf);
+static void bstart_request(buf_block_t buf, disk_request_type_t type,
+                           void (*func)(disk_completion_t done));
+static void bstart_write(buf_block_t buf);
+static void bwrite_done(disk_completion_t done);
+static void bread_done(disk_completion_t done);
+
+/*
+ * Initialize buffer cache with nblocks blocks, or BUFFER_CACHE_BLOCKS if
+ * nblocks is 0, allocating all of them up front.
+ */
 int
-minifile_buf_cache_init()
+minifile_buf_cache_init(size_t nblocks)
 {
-    int i;
+    buf_block_t blocks;
+    size_t i;
+
+    if (0 == nblocks)
+        nblocks = BUFFER_CACHE_BLOCKS;
 
     disk_lim = semaphore_new(MAX_PENDING_DISK_REQUESTS);
     bc = malloc(sizeof(struct buf_cache));
     if (NULL == disk_lim || NULL == bc)
         goto err1;
 
-    bc->hash_val = BUFFER_CACHE_HASH_VALUE;
-    bc->num_blocks = 0;
+    /* Data first, so every block starts on a page */
+    bc->num_blocks = nblocks;
+    bc->arena_size = nblocks * (DISK_BLOCK_SIZE + sizeof(struct buf_block));
+    bc->arena = mmap(NULL, bc->arena_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == bc->arena)
+        goto err1;
+    blocks = (buf_block_t) (bc->arena + nblocks * DISK_BLOCK_SIZE);
+    bc->free_list = NULL;
+    for (i = nblocks; i-- > 0; ) {
+        blocks[i].data = bc->arena + i * DISK_BLOCK_SIZE;
+        blocks[i].flags = 0;
+        blocks[i].refs = 0;
+        blocks[i].in_lru = 0;
+        blocks[i].lru_gen = 0;
+        semaphore_initialize(&(blocks[i].lock), 1);
+        blocks[i].hash_next = bc->free_list;
+        bc->free_list = &(blocks[i]);
+    }
+
+    bc->num_dirty = 0;
+    bc->flush_threshold = nblocks / FLUSH_SHARE;
+    if (bc->flush_threshold < 1)
+        bc->flush_threshold = 1;
+    bc->flush_tick = 0;
+    bc->readahead = 0;
 
     bc->locked = queue_new();
     bc->lru = queue_new();
+    bc->io_done = queue_new();
     for (i = 0; i < BUFFER_CACHE_HASH_VALUE; ++i) {
-        bc->block_lock[i] = semaphore_new(1);
-        bc->block_sig[i] = semaphore_new(0);
+        semaphore_initialize(&(bc->hash_lock[i]), 1);
     }
-    bc->cache_lock = semaphore_new(1);
+    semaphore_initialize(&(bc->flush_sig), 0);
+    bc->cache_lock = mutex_create();
+    bc->block_free = cond_create();
 
-    if (NULL == bc->locked || NULL == bc->lru || NULL == bc->cache_lock) {
+    if (NULL == bc->locked || NULL == bc->lru || NULL == bc->io_done
+            || NULL == bc->cache_lock || NULL == bc->block_free) {
         goto err2;
     }
-    for (i = 0; i < BUFFER_CACHE_HASH_VALUE; ++i) {
-        if (NULL == bc->block_sig[i] || NULL == bc->block_lock[i]) {
-            goto err2;
-        }
-    }
 
     return 0;
 
 err2:
     queue_free(bc->locked);
     queue_free(bc->lru);
-    semaphore_destroy(bc->cache_lock);
-    for (i = 0; i < BUFFER_CACHE_HASH_VALUE; ++i) {
-        semaphore_destroy(bc->block_lock[i]);
-        semaphore_destroy(bc->block_sig[i]);
-    }
+    queue_free(bc->io_done);
+    mutex_destroy(bc->cache_lock);
+    cond_destroy(bc->block_free);
+    munmap(bc->arena, bc->arena_size);
 err1:
     semaphore_destroy(disk_lim);
     free(bc);
@@ -108,9 +160,10 @@ hash_add(buf_block_t block, blocknum_t bhash)
 static void
 hash_remove(buf_block_t block, blocknum_t bhash)
 {
-    bc->hash[bhash] = block->hash_next;
     if (block->hash_prev != NULL) {
         block->hash_prev->hash_next = block->hash_next;
+    } else {
+        bc->hash[bhash] = block->hash_next;
     }
     if (block->hash_next != NULL) {
         block->hash_next->hash_prev = block->hash_prev;
@@ -119,112 +172,417 @@ hash_remove(buf_block_t block, blocknum_t bhash)
     block->hash_next = NULL;
 }
 
-static buf_block_t
-get_buf_block()
+/* Put an unused block at the end of the LRU list */
+static void
+lru_append(buf_block_t block)
 {
-    buf_block_t block = NULL;
+    mutex_lock(bc->cache_lock);
+    queue_append(bc->lru, block);
+    block->in_lru = 1;
+    ++block->lru_gen;
+    cond_signal(bc->block_free);
+    mutex_unlock(bc->cache_lock);
+}
 
-    if (bc->num_blocks > bc->hash_val) {
-        queue_dequeue(bc->lru, (void**)&block);
-    }
-    if (NULL == block) {
-        block = malloc(sizeof(struct buf_block));
-    }
-    else {
-        if (BLOCK_DIRTY == block->state) {
-            blocking_write(block);
+/* Take a block off the LRU list, if it is on it */
+static void
+lru_remove(buf_block_t block)
+{
+    mutex_lock(bc->cache_lock);
+    if (block->in_lru)
+        queue_delete(bc->lru, (void**)&block);
+    block->in_lru = 0;
+    mutex_unlock(bc->cache_lock);
+}
+
+/*
+ * P and V of the semaphores that interrupt handlers V too: disk_lim, the
+ * block locks and flush_sig. Interrupts are disabled, so that a handler
+ * never spins on the TAS lock of a semaphore the interrupted thread holds.
+ */
+static void
+io_sem_P(semaphore_t sem)
+{
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    semaphore_P(sem);
+    set_interrupt_level(oldlevel);
+}
+
+static void
+io_sem_V(semaphore_t sem)
+{
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    semaphore_V(sem);
+    set_interrupt_level(oldlevel);
+}
+
+/*
+ * Return a buffer outside the hash table: a free one, otherwise the least
+ * recently used clean block. Dirty blocks on the way are written back in
+ * the background rather than waited for. When every block is in use,
+ * wait for one to be released if wait is set, or return NULL. Without
+ * wait the caller only reads speculatively, so it also gets NULL rather
+ * than push a dirty block out.
+ */
+static buf_block_t
+get_buf_block(int wait)
+{
+    buf_block_t block;
+    semaphore_t lock;
+    unsigned int gen;
+
+    for (;;) {
+        mutex_lock(bc->cache_lock);
+        while (NULL == (block = bc->free_list)) {
+            queue_dequeue(bc->lru, (void**)&block);
+            if (NULL != block && !wait && (block->flags & BLOCK_DIRTY)) {
+                queue_prepend(bc->lru, block);
+                mutex_unlock(bc->cache_lock);
+                return NULL;
+            }
+            if (NULL != block) {
+                block->in_lru = 0;
+                break;
+            }
+            if (!wait) {
+                mutex_unlock(bc->cache_lock);
+                return NULL;
+            }
+            cond_wait(bc->block_free, bc->cache_lock);
+        }
+        if (block == bc->free_list) {
+            bc->free_list = block->hash_next;
+            block->hash_next = NULL;
+            mutex_unlock(bc->cache_lock);
+            return block;
+        }
+        gen = block->lru_gen;
+        mutex_unlock(bc->cache_lock);
+
+        /*
+         * The block may have been taken again since it was dequeued, and
+         * even released and dequeued by another thread, which bumps its
+         * generation. Only the thread that dequeued it last may claim it.
+         */
+        lock = &(bc->hash_lock[BLOCK_NUM_HASH(block->num)]);
+        semaphore_P(lock);
+        if (block->refs > 0 || block->lru_gen != gen) {
+            semaphore_V(lock);
+            continue;
+        }
+        if (block->flags & BLOCK_DIRTY) {
+            block_grab(block);
+            semaphore_V(lock);
+            bstart_write(block);
+            continue;
         }
         hash_remove(block, BLOCK_NUM_HASH(block->num));
+        lru_remove(block);
+        semaphore_V(lock);
+        block->flags = 0;
+        return block;
     }
+}
 
-    return block;
+/* Give back a buffer from get_buf_block that was not used */
+static void
+put_buf_block(buf_block_t block)
+{
+    block->flags = 0;
+    mutex_lock(bc->cache_lock);
+    block->hash_next = bc->free_list;
+    bc->free_list = block;
+    cond_signal(bc->block_free);
+    mutex_unlock(bc->cache_lock);
 }
 
+/*
+ * Send a request of type for buf to the disk and wait for its reply.
+ * Each request waits on its own completion, so any number of blocks,
+ * up to MAX_PENDING_DISK_REQUESTS, can be in flight at once.
+ */
+static disk_reply_t
+blocking_request(buf_block_t buf, disk_request_type_t type)
+{
+    struct disk_completion done;
+
+    semaphore_initialize(&(done.sig), 0);
+    done.func = NULL;
+    io_sem_P(disk_lim);
+    buf->flags |= BLOCK_IO;
+    if (disk_send_request_token(buf->disk, buf->num, buf->data, type,
+                                &done) != 0) {
+        done.reply = DISK_REPLY_FAILED;
+    } else {
+        io_sem_P(&(done.sig));
+    }
+    buf->flags &= ~BLOCK_IO;
+    io_sem_V(disk_lim);
+
+    return done.reply;
+}
+
+/* Read buf in from disk. The caller holds buf. */
 static disk_reply_t
 blocking_read(buf_block_t buf)
+{
+    disk_reply_t reply = blocking_request(buf, DISK_READ);
+    if (DISK_REPLY_OK == reply) {
+        buf->flags |= BLOCK_VALID;
+    }
+    return reply;
+}
+
+/* Write buf back to disk. The caller holds buf. */
+disk_reply_t
+blocking_write(buf_block_t buf)
+{
+    disk_reply_t reply = blocking_request(buf, DISK_WRITE);
+    if (DISK_REPLY_OK == reply) {
+        block_clean(buf);
+    }
+    return reply;
+}
+
+/*
+ * Hold block, whose hash lock is held, without waiting. Its refs must
+ * be 0, so no thread holds or waits for it.
+ */
+static void
+block_grab(buf_block_t block)
+{
+    ++block->refs;
+    lru_remove(block);
+    io_sem_P(&(block->lock));
+    block->flags |= BLOCK_BUSY;
+}
+
+/* Mark held buf dirty. Wake the flusher when too many blocks are. */
+static void
+block_dirty(buf_block_t buf)
 {
     interrupt_level_t oldlevel;
-    blocknum_t bhash = BLOCK_NUM_HASH(buf->num);
 
-    semaphore_P(disk_lim);
-    disk_read_block(buf->disk, buf->num, buf->data);
+    buf->flags |= BLOCK_VALID;
+    if (buf->flags & BLOCK_DIRTY)
+        return;
+    buf->flags |= BLOCK_DIRTY;
+    buf->dirtied = alarm_now();
     oldlevel = set_interrupt_level(DISABLED);
-    semaphore_P(bc->block_sig[bhash]);
+    if (++bc->num_dirty >= bc->flush_threshold)
+        semaphore_V(&(bc->flush_sig));
     set_interrupt_level(oldlevel);
-    semaphore_V(disk_lim);
-    if (DISK_REPLY_OK == bc->reply[bhash]) {
-        buf->state = BLOCK_CLEAN;
-    }
-
-    return bc->reply[bhash];
 }
 
-disk_reply_t
-blocking_write(buf_block_t buf)
+/* Mark held buf clean once written back */
+static void
+block_clean(buf_block_t buf)
 {
     interrupt_level_t oldlevel;
-    blocknum_t bhash = BLOCK_NUM_HASH(buf->num);
 
-    semaphore_P(disk_lim);
-    disk_write_block(buf->disk, buf->num, buf->data);
+    if (!(buf->flags & BLOCK_DIRTY))
+        return;
+    buf->flags &= ~BLOCK_DIRTY;
     oldlevel = set_interrupt_level(DISABLED);
-    semaphore_P(bc->block_sig[bhash]);
+    --bc->num_dirty;
     set_interrupt_level(oldlevel);
-    semaphore_V(disk_lim);
-    if (DISK_REPLY_OK == bc->reply[bhash]) {
-        buf->state = BLOCK_CLEAN;
+}
+
+/*
+ * Send a request of type for held buf without waiting for the disk. The
+ * block stays held until the request completes and func releases it.
+ */
+static void
+bstart_request(buf_block_t buf, disk_request_type_t type,
+               void (*func)(disk_completion_t done))
+{
+    interrupt_level_t oldlevel;
+
+    io_sem_P(disk_lim);
+    buf->flags |= BLOCK_IO;
+    buf->io.func = func;
+    buf->io.arg = buf;
+    if (disk_send_request_token(buf->disk, buf->num, buf->data, type,
+                                &(buf->io)) != 0) {
+        buf->io.reply = DISK_REPLY_FAILED;
+        oldlevel = set_interrupt_level(DISABLED);
+        func(&(buf->io));
+        set_interrupt_level(oldlevel);
     }
+}
+
+/* Start writing back held buf, released when the write completes */
+static void
+bstart_write(buf_block_t buf)
+{
+    bstart_request(buf, DISK_WRITE, bwrite_done);
+}
 
-    return bc->reply[bhash];
+/*
+ * Release a block after its asynchronous request, in the disk handler.
+ * The block is unlocked here, and the flusher drops its reference,
+ * which needs the hash lock.
+ */
+static void
+bio_release(buf_block_t buf)
+{
+    semaphore_V(disk_lim);
+    buf->flags &= ~(BLOCK_IO | BLOCK_BUSY);
+    semaphore_V_io(&(buf->lock));
+    queue_append(bc->io_done, buf);
+    semaphore_V(&(bc->flush_sig));
 }
 
-/* For block n, get a pointer to its block buffer */
+/* Completion of an asynchronous write, called by the disk handler */
+static void
+bwrite_done(disk_completion_t done)
+{
+    buf_block_t buf = done->arg;
+
+    if (DISK_REPLY_OK == done->reply)
+        block_clean(buf);
+    bio_release(buf);
+}
+
+/* Completion of an asynchronous read, called by the disk handler */
+static void
+bread_done(disk_completion_t done)
+{
+    buf_block_t buf = done->arg;
+
+    if (DISK_REPLY_OK == done->reply)
+        buf->flags |= BLOCK_VALID;
+    bio_release(buf);
+}
+
+/*
+ * For block n, get a pointer to its block buffer. Wait while another
+ * thread holds the block, and read it in if it is not valid.
+ */
 int
 bread(disk_t* disk, blocknum_t n, buf_block_t *bufp)
 {
     blocknum_t bhash = BLOCK_NUM_HASH(n);
+    buf_block_t buf;
+    buf_block_t fresh = NULL;
 
     if (NULL == bufp || NULL == disk || disk->layout.size < n) {
         return -1;
     }
 
-    semaphore_P(bc->block_lock[bhash]);
-    semaphore_P(bc->cache_lock);
+    semaphore_P(&(bc->hash_lock[bhash]));
+    buf = hash_find(disk, n, bhash);
+    if (NULL == buf) {
+        /* Get a buffer without holding the hash lock, then look again */
+        semaphore_V(&(bc->hash_lock[bhash]));
+        fresh = get_buf_block(1);
+        if (NULL == fresh) {
+            return -1;
+        }
+        semaphore_P(&(bc->hash_lock[bhash]));
+        buf = hash_find(disk, n, bhash);
+        if (NULL == buf) {
+            buf = fresh;
+            fresh = NULL;
+            buf->disk = disk;
+            buf->num = n;
+            hash_add(buf, bhash);
+        }
+    }
+    if (0 == buf->refs++) {
+        lru_remove(buf);
+    }
+    semaphore_V(&(bc->hash_lock[bhash]));
+    if (NULL != fresh) {
+        put_buf_block(fresh);
+    }
 
-    *bufp = hash_find(disk, n, bhash);
+    io_sem_P(&(buf->lock));
+    buf->flags |= BLOCK_BUSY;
+    if (!(buf->flags & BLOCK_VALID)) {
+        blocking_read(buf);
+    }
+    *bufp = buf;
 
-    if (NULL != *bufp) {
-        queue_delete(bc->lru, (void**)bufp);
-    } else {
-        semaphore_V(bc->cache_lock);
+    return 0;
+}
 
-        *bufp = get_buf_block();
-        if (NULL == *bufp) {
-            return -1;
-        }
-        (*bufp)->disk = disk;
-        (*bufp)->num = n;
-        blocking_read(*bufp);
+/*
+ * Start reading block n into the cache without waiting for it, unless it
+ * is cached already. A thread reading the block meanwhile waits for the
+ * read to complete, and reads it again itself if the read failed.
+ */
+int
+bprefetch(disk_t* disk, blocknum_t n)
+{
+    blocknum_t bhash = BLOCK_NUM_HASH(n);
+    buf_block_t buf;
 
-        semaphore_P(bc->cache_lock);
+    if (NULL == disk || disk->layout.size < n || n <= 0) {
+        return -1;
+    }
 
-        hash_add(*bufp, bhash);
+    semaphore_P(&(bc->hash_lock[bhash]));
+    buf = hash_find(disk, n, bhash);
+    semaphore_V(&(bc->hash_lock[bhash]));
+    if (NULL != buf) {
+        return 0;
     }
 
-    semaphore_V(bc->cache_lock);
+    /* Reading ahead is only worth a free or clean block, without waiting */
+    buf = get_buf_block(0);
+    if (NULL == buf) {
+        return -1;
+    }
+    semaphore_P(&(bc->hash_lock[bhash]));
+    if (NULL != hash_find(disk, n, bhash)) {
+        semaphore_V(&(bc->hash_lock[bhash]));
+        put_buf_block(buf);
+        return 0;
+    }
+    buf->disk = disk;
+    buf->num = n;
+    hash_add(buf, bhash);
+    block_grab(buf);
+    semaphore_V(&(bc->hash_lock[bhash]));
+    bstart_request(buf, DISK_READ, bread_done);
 
     return 0;
 }
 
+/*
+ * Like bread, after starting the reads of the nahead blocks in ahead,
+ * which go to the disk after block n if it has to be read in too.
+ */
+int
+breada(disk_t* disk, blocknum_t n, blocknum_t *ahead, int nahead,
+       buf_block_t *bufp)
+{
+    int i;
+
+    if (nahead > 0) {
+        bc->readahead += nahead;
+        bprefetch(disk, n);
+        for (i = 0; i < nahead; ++i)
+            bprefetch(disk, ahead[i]);
+    }
+    return bread(disk, n, bufp);
+}
+
 
 /* Only release the buffer, no write scheduled */
 int
 brelse(buf_block_t buf)
 {
-    semaphore_P(bc->cache_lock);
-    queue_append(bc->lru, buf);
-    semaphore_V(bc->cache_lock);
-    semaphore_V(bc->block_lock[BLOCK_NUM_HASH(buf->num)]);
+    blocknum_t bhash = BLOCK_NUM_HASH(buf->num);
+
+    buf->flags &= ~BLOCK_BUSY;
+    io_sem_V(&(buf->lock));
+    semaphore_P(&(bc->hash_lock[bhash]));
+    if (0 == --buf->refs) {
+        lru_append(buf);
+    }
+    semaphore_V(&(bc->hash_lock[bhash]));
     return 0;
 }
 
@@ -243,17 +601,148 @@ bwrite(buf_block_t buf)
 void
 bawrite(buf_block_t buf)
 {
-    bdwrite(buf);
+    block_dirty(buf);
+    bstart_write(buf);
 }
 
 /* Only mark buffer dirty, no write scheduled */
 void
 bdwrite(buf_block_t buf)
 {
-    buf->state = BLOCK_DIRTY;
+    block_dirty(buf);
     brelse(buf);
 }
 
+/* Write back every dirty block, waiting for the writes */
+int
+bsync()
+{
+    int h;
+    int r = 0;
+    buf_block_t buf;
+    buf_block_t next;
+
+    for (h = 0; h < BUFFER_CACHE_HASH_VALUE; ++h) {
+        semaphore_P(&(bc->hash_lock[h]));
+        for (buf = bc->hash[h]; NULL != buf; buf = next) {
+            if (!(buf->flags & BLOCK_DIRTY)) {
+                next = buf->hash_next;
+                continue;
+            }
+            if (0 == buf->refs++) {
+                lru_remove(buf);
+            }
+            semaphore_V(&(bc->hash_lock[h]));
+            io_sem_P(&(buf->lock));
+            if ((buf->flags & BLOCK_DIRTY)
+                    && DISK_REPLY_OK != blocking_write(buf)) {
+                r = -1;
+            }
+            io_sem_V(&(buf->lock));
+            semaphore_P(&(bc->hash_lock[h]));
+            next = buf->hash_next;
+            if (0 == --buf->refs) {
+                lru_append(buf);
+            }
+        }
+        semaphore_V(&(bc->hash_lock[h]));
+    }
+    return r;
+}
+
+/* Drop the references of the blocks whose asynchronous request completed */
+static void
+bflush_reap()
+{
+    interrupt_level_t oldlevel;
+    buf_block_t buf;
+    blocknum_t bhash;
+
+    for (;;) {
+        oldlevel = set_interrupt_level(DISABLED);
+        queue_dequeue(bc->io_done, (void**)&buf);
+        set_interrupt_level(oldlevel);
+        if (NULL == buf)
+            return;
+        bhash = BLOCK_NUM_HASH(buf->num);
+        semaphore_P(&(bc->hash_lock[bhash]));
+        if (0 == --buf->refs) {
+            lru_append(buf);
+        }
+        semaphore_V(&(bc->hash_lock[bhash]));
+    }
+}
+
+/*
+ * Start writing back a batch of the unused dirty blocks that became
+ * dirty at or before time before, or of any of them if before is -1.
+ */
+static void
+bflush(long before)
+{
+    buf_block_t batch[FLUSH_BATCH];
+    buf_block_t buf;
+    int n = 0;
+    int h;
+    int i;
+
+    for (h = 0; h < BUFFER_CACHE_HASH_VALUE && n < FLUSH_BATCH; ++h) {
+        semaphore_P(&(bc->hash_lock[h]));
+        for (buf = bc->hash[h]; NULL != buf && n < FLUSH_BATCH;
+                buf = buf->hash_next) {
+            if (buf->refs > 0 || !(buf->flags & BLOCK_DIRTY))
+                continue;
+            if (-1 != before && buf->dirtied > before)
+                continue;
+            block_grab(buf);
+            batch[n++] = buf;
+        }
+        semaphore_V(&(bc->hash_lock[h]));
+    }
+    for (i = 0; i < n; ++i)
+        bstart_write(batch[i]);
+}
+
+static void
+bflush_tick(void *arg)
+{
+    bc->flush_tick = 1;
+    semaphore_V(&(bc->flush_sig));
+}
+
+/*
+ * Flusher thread. Woken by its alarm, by an asynchronous request
+ * completing, or by the number of dirty blocks reaching flush_threshold.
+ */
+static int
+bflush_thread(int *arg)
+{
+    register_alarm(FLUSH_PERIOD, bflush_tick, NULL);
+    for (;;) {
+        io_sem_P(&(bc->flush_sig));
+        bflush_reap();
+        if (bc->num_dirty >= bc->flush_threshold) {
+            bflush(-1);
+        } else if (bc->flush_tick) {
+            bflush(alarm_now() - FLUSH_AGE);
+        }
+        if (bc->flush_tick) {
+            bc->flush_tick = 0;
+            register_alarm(FLUSH_PERIOD, bflush_tick, NULL);
+        }
+    }
+    return 0;
+}
+
+/* Start the flusher thread, once interrupts and alarms are set up */
+int
+minifile_buf_cache_start()
+{
+    if (NULL == minithread_fork(bflush_thread, NULL))
+        return -1;
+    return 0;
+}
+
 /* 'Pull' data from disk */
 int
 bpull(blocknum_t from_block, char* to)
@@ -12,6 +12,28 @@
 #define BUFFER_CACHE_HASH_VALUE 1024
 #define BLOCK_NUM_HASH(n) ((n) & 1023)
 
+/* Default buffer cache size in blocks, and the size of mb megabytes */
+#define BUFFER_CACHE_BLOCKS 1024
+#define BUFFER_CACHE_MB(mb) ((size_t) (mb) * 1024 * 1024 / DISK_BLOCK_SIZE)
+
+/*
+ * Number of blocks in the buffer cache. Set it in the linked main program
+ * before initialization, e.g. to BUFFER_CACHE_MB(16). Defaults to
+ * BUFFER_CACHE_BLOCKS.
+ */
+extern size_t buffer_cache_blocks;
+
+/*
+ * Write-behind. Every FLUSH_PERIOD ms the flusher thread writes back the
+ * unused blocks dirty for FLUSH_AGE ms or more, and whenever at least one
+ * FLUSH_SHARE-th of the cache is dirty it writes back any unused dirty
+ * block, starting up to FLUSH_BATCH writes at a time.
+ */
+#define FLUSH_PERIOD 1000
+#define FLUSH_AGE 3000
+#define FLUSH_SHARE 4
+#define FLUSH_BATCH 64
+
 /* Supported disk address space */
 typedef int64_t blocknum_t;
 
@@ -23,44 +45,89 @@ disk_t *maindisk;
 semaphore_t disk_lim;
 
 /* Data structures for buffer cache and cached items */
-typedef enum block_state block_state_t;
 typedef struct buf_block *buf_block_t;
 typedef struct buf_cache *buf_cache_t;
 
-enum block_state {
-    BLOCK_EMPTY,
-    BLOCK_CLEAN,
-    BLOCK_DIRTY
+/* Flags of a buffer, changed only by the thread holding its lock */
+#define BLOCK_BUSY  0x1     /* Held by a thread, from bread to its release */
+#define BLOCK_VALID 0x2     /* Data has been read from disk, or written */
+#define BLOCK_DIRTY 0x4     /* Data is newer than the disk block */
+#define BLOCK_IO    0x8     /* A disk request on the data is in progress */
+
+/*
+ * Completion of one disk request, passed to the disk handler as the
+ * token of the request. The handler stores the reply, then calls func
+ * with interrupts disabled if it is set, or signals sig.
+ */
+typedef struct disk_completion *disk_completion_t;
+
+struct disk_completion {
+    struct semaphore sig;
+    disk_reply_t reply;
+    void (*func)(disk_completion_t done);
+    void *arg;
 };
 
+/*
+ * A cached block. lock is held by the thread using the block, or reading
+ * it in, from bread until the block is released; others wanting the
+ * block wait on it. refs counts those threads, and a block is on the
+ * LRU list, and can be recycled, only when it is 0. The hash links and
+ * refs are protected by the hash lock of the block, the LRU links,
+ * in_lru and lru_gen, bumped each time the block goes on the LRU list,
+ * by the cache lock. While an asynchronous write is in progress
+ * the block is held for the write, and io is its completion. A block
+ * holding no disk block is on the free list instead, through hash_next.
+ */
 struct buf_block {
     struct node node;
     buf_block_t hash_prev;          /* Previous item in hash table entry */
     buf_block_t hash_next;          /* Next item in hash table entry */
-    char data[DISK_BLOCK_SIZE];
+    char *data;                     /* Page-aligned, in the arena */
     disk_t* disk;
     blocknum_t num;
-    block_state_t state;
+    int flags;
+    int refs;
+    int in_lru;
+    unsigned int lru_gen;
+    long dirtied;                   /* Time the block became dirty, in ms */
+    struct semaphore lock;
+    struct disk_completion io;
 };
 
+/*
+ * The cache. Its blocks are allocated once, in the arena: the data of
+ * every block, one page each, followed by the buf_blocks.
+ */
 struct buf_cache {
-    size_t hash_val;
     size_t num_blocks;
-    semaphore_t cache_lock;
-    semaphore_t block_lock[BUFFER_CACHE_HASH_VALUE];
-    semaphore_t block_sig[BUFFER_CACHE_HASH_VALUE];
+    char *arena;
+    size_t arena_size;
+    buf_block_t free_list;
+    mutex_t cache_lock;             /* LRU list and free list */
+    cond_t block_free;              /* A block was freed or released */
+    struct semaphore hash_lock[BUFFER_CACHE_HASH_VALUE];
     buf_block_t hash[BUFFER_CACHE_HASH_VALUE];
-    disk_reply_t reply[BUFFER_CACHE_HASH_VALUE];
     queue_t locked;
     queue_t lru;
+    int num_dirty;                  /* Changed with interrupts disabled */
+    int flush_threshold;            /* num_dirty waking the flusher */
+    queue_t io_done;                /* Blocks done with async I/O, to release */
+    int flush_tick;                 /* Set by the flusher alarm */
+    struct semaphore flush_sig;     /* Wakes the flusher */
+    long readahead;                 /* Blocks breada was asked to read ahead */
 };
 
 /* Global cache */
 buf_cache_t bc;
 
 /* Buffer cache interface, explained before implementations */
-extern int minifile_buf_cache_init();
+extern int minifile_buf_cache_init(size_t nblocks);
+extern int minifile_buf_cache_start();
 extern int bread(disk_t* disk, blocknum_t n, buf_block_t *bufp);
+extern int breada(disk_t* disk, blocknum_t n, blocknum_t *ahead, int nahead,
+                  buf_block_t *bufp);
+extern int bprefetch(disk_t* disk, blocknum_t n);
 extern int brelse(buf_block_t buf);
 extern int bwrite(buf_block_t buf);
 extern void bawrite(buf_block_t buf);
@@ -69,6 +136,7 @@ extern int bpull(blocknum_t from_block, char* to);
 extern int bpush(blocknum_t to_block, char* from);
 extern int bapush(blocknum_t to_block, char* from);
 extern disk_reply_t blocking_write(buf_block_t buf);
+extern int bsync();
 
 #endif /* __MINIFILE_CACHE_H__ */
 
@@ -5,10 +5,39 @@
 #include "minithread.h"
 #include "synch.h"
 
-static blocknum_t disk_num_blocks = 128;
+static blocknum_t disk_num_blocks = 2048;
+
+/* Blocks in the cache, fewer than the test uses, so blocks get recycled */
+#define CACHE_BLOCKS 32
 static semaphore_t sig;
 static int shift[10];
 
+/* Threads writing distinct blocks at once, each waiting on its own reply */
+#define NUM_INFLIGHT 16
+static blocknum_t inflight_block[NUM_INFLIGHT];
+static int inflight = 0;
+static int most_inflight = 0;
+
+int cache_inflight_test(int *arg)
+{
+    buf_block_t buf;
+    blocknum_t i;
+    blocknum_t n = *(blocknum_t*)arg;
+    blocknum_t* block;
+
+    bread(maindisk, n, &buf);
+    block = (blocknum_t*) buf->data;
+    for (i = 0; i < DISK_BLOCK_SIZE / sizeof(blocknum_t); ++i)
+        block[i] = i * n;
+    if (++inflight > most_inflight)
+        most_inflight = inflight;
+    bwrite(buf);
+    --inflight;
+
+    semaphore_V(sig);
+    return 0;
+}
+
 int cache_multithread_test(int *arg)
 {
     buf_block_t buf;
@@ -26,11 +55,72 @@ int cache_multithread_test(int *arg)
     return 0;
 }
 
+/*
+ * Threads incrementing counters in more blocks than the cache may hold,
+ * so blocks are recycled, dirty ones written back, while in use.
+ */
+#define NUM_EVICT_THREADS 8
+#define NUM_EVICT_BLOCKS 64
+#define NUM_EVICT_ROUNDS 200
+
+/* Blocks sharing a hash bucket, the first one evicted from behind the head */
+#define COLLIDE_BLOCK 5
+#define COLLIDE_OTHER (COLLIDE_BLOCK + BUFFER_CACHE_HASH_VALUE)
+
+/* Threads holding more blocks at once than the cache has */
+#define NUM_HOLD_THREADS (CACHE_BLOCKS + 8)
+static int hold_block[NUM_HOLD_THREADS];
+static int holding = 0;
+static int most_holding = 0;
+static int misaligned = 0;
+
+int cache_hold_test(int *arg)
+{
+    buf_block_t buf;
+    int i;
+
+    bread(maindisk, 1 + *arg, &buf);
+    if ((uintptr_t) buf->data % DISK_BLOCK_SIZE != 0)
+        ++misaligned;
+    if (++holding > most_holding)
+        most_holding = holding;
+    for (i = 0; i < 10; ++i)
+        minithread_yield();
+    --holding;
+    brelse(buf);
+
+    semaphore_V(sig);
+    return 0;
+}
+
+int cache_evict_test(int *arg)
+{
+    buf_block_t buf;
+    blocknum_t n;
+    int i;
+
+    for (i = 0; i < NUM_EVICT_ROUNDS; ++i) {
+        n = 1 + (i * 7 + *arg * 13) % NUM_EVICT_BLOCKS;
+        bread(maindisk, n, &buf);
+        ++((blocknum_t*) buf->data)[0];
+        minithread_yield();
+        bdwrite(buf);
+    }
+
+    semaphore_V(sig);
+    return 0;
+}
+
+/* Blocks read ahead of each block streamed, through a small cache */
+#define READAHEAD_BLOCKS 8
+
 int cache_test(int *arg)
 {
     buf_block_t buf;
-    blocknum_t i, j;
+    buf_block_t held;
+    blocknum_t i, j, k;
     blocknum_t* block;
+    blocknum_t ahead[READAHEAD_BLOCKS];
 
     bread(maindisk, 0, &buf);
     block = (blocknum_t*) buf->data;
@@ -90,6 +180,128 @@ int cache_test(int *arg)
     brelse(buf);
     printf("Check finished\n");
 
+    for (j = 0; j < NUM_INFLIGHT; ++j) {
+        inflight_block[j] = j + 1;
+        minithread_fork(cache_inflight_test, (int*)&(inflight_block[j]));
+    }
+    for (j = 0; j < NUM_INFLIGHT; ++j) {
+        semaphore_P(sig);
+    }
+
+    printf("Checking %d blocks written with up to %d in flight... ",
+           NUM_INFLIGHT, most_inflight);
+    for (j = 0; j < NUM_INFLIGHT; ++j) {
+        bread(maindisk, inflight_block[j], &buf);
+        block = (blocknum_t*) buf->data;
+        for (i = 0; i < DISK_BLOCK_SIZE / sizeof(blocknum_t); ++i) {
+            if (block[i] != i * inflight_block[j]) {
+                printf("Error in block %ld!\n", inflight_block[j]);
+                break;
+            }
+        }
+        brelse(buf);
+    }
+    printf("Check finished\n");
+
+    /* Blocks get recycled from here on */
+    for (j = 1; j <= NUM_EVICT_BLOCKS; ++j) {
+        bread(maindisk, j, &buf);
+        ((blocknum_t*) buf->data)[0] = 0;
+        bwrite(buf);
+    }
+    for (j = 0; j < NUM_EVICT_THREADS; ++j) {
+        shift[j] = j;
+        minithread_fork(cache_evict_test, &(shift[j]));
+    }
+    for (j = 0; j < NUM_EVICT_THREADS; ++j) {
+        semaphore_P(sig);
+    }
+    i = 0;
+    for (j = 1; j <= NUM_EVICT_BLOCKS; ++j) {
+        bread(maindisk, j, &buf);
+        i += ((blocknum_t*) buf->data)[0];
+        brelse(buf);
+    }
+    printf("Counted %ld increments through a cache of %d blocks, expected %d.\n",
+           i, CACHE_BLOCKS, NUM_EVICT_THREADS * NUM_EVICT_ROUNDS);
+    if (i != NUM_EVICT_THREADS * NUM_EVICT_ROUNDS)
+        exit(1);
+
+    /* Evicting a block must not unlink the one hashed in front of it */
+    bread(maindisk, COLLIDE_BLOCK, &buf);
+    brelse(buf);
+    bread(maindisk, COLLIDE_OTHER, &held);
+    ((blocknum_t*) held->data)[0] = COLLIDE_OTHER;
+    for (j = 1; j <= NUM_EVICT_BLOCKS; ++j) {
+        bread(maindisk, (j == COLLIDE_BLOCK) ? 2 * NUM_EVICT_BLOCKS : j, &buf);
+        brelse(buf);
+    }
+    bdwrite(held);
+    bread(maindisk, COLLIDE_OTHER, &buf);
+    printf("Block %d after evicting block %d from its bucket: %ld.\n",
+           COLLIDE_OTHER, COLLIDE_BLOCK, ((blocknum_t*) buf->data)[0]);
+    if (((blocknum_t*) buf->data)[0] != COLLIDE_OTHER)
+        exit(1);
+    brelse(buf);
+
+    /* Write-behind: bawrite returns at once, bsync and the flusher clean */
+    for (j = 1; j <= NUM_EVICT_BLOCKS; ++j) {
+        bread(maindisk, j, &buf);
+        ((blocknum_t*) buf->data)[1] = j;
+        if (j % 2)
+            bawrite(buf);
+        else
+            bdwrite(buf);
+    }
+    printf("Dirty blocks: %d after bawrite and bdwrite, ", bc->num_dirty);
+    bsync();
+    printf("%d after bsync, ", bc->num_dirty);
+    if (bc->num_dirty != 0)
+        exit(1);
+    for (j = 1; j <= NUM_EVICT_BLOCKS; ++j) {
+        bread(maindisk, j, &buf);
+        bdwrite(buf);
+    }
+    minithread_sleep_with_timeout(FLUSH_AGE + 2 * FLUSH_PERIOD);
+    printf("%d left by the flusher after %d ms.\n", bc->num_dirty,
+           FLUSH_AGE + 2 * FLUSH_PERIOD);
+    if (bc->num_dirty != 0)
+        exit(1);
+
+    /* Read-ahead: push the blocks out, then stream them back in */
+    for (j = NUM_EVICT_BLOCKS + 1; j < 2 * NUM_EVICT_BLOCKS; ++j) {
+        bread(maindisk, j, &buf);
+        brelse(buf);
+    }
+    k = 0;
+    for (j = 1; j <= NUM_EVICT_BLOCKS; ++j) {
+        for (i = 0; i < READAHEAD_BLOCKS; ++i)
+            ahead[i] = j + 1 + i;
+        breada(maindisk, j, ahead,
+               (j + READAHEAD_BLOCKS <= NUM_EVICT_BLOCKS) ? READAHEAD_BLOCKS : 0,
+               &buf);
+        if (((blocknum_t*) buf->data)[1] != j)
+            ++k;
+        brelse(buf);
+    }
+    printf("Streamed %d blocks reading %d ahead, %ld wrong.\n",
+           NUM_EVICT_BLOCKS, READAHEAD_BLOCKS, k);
+    if (k != 0)
+        exit(1);
+
+    /* Bounded cache: threads wait for blocks rather than allocating */
+    for (j = 0; j < NUM_HOLD_THREADS; ++j) {
+        hold_block[j] = j;
+        minithread_fork(cache_hold_test, &(hold_block[j]));
+    }
+    for (j = 0; j < NUM_HOLD_THREADS; ++j) {
+        semaphore_P(sig);
+    }
+    printf("%d threads held up to %d of %d blocks, %d misaligned.\n",
+           NUM_HOLD_THREADS, most_holding, CACHE_BLOCKS, misaligned);
+    if (most_holding > CACHE_BLOCKS || misaligned != 0)
+        exit(1);
+
     return 0;
 }
 
@@ -99,6 +311,7 @@ int main(int argc, char** argv)
     disk_name = "minidisk";
     disk_flags = DISK_READWRITE;
     disk_size = disk_num_blocks;
+    buffer_cache_blocks = CACHE_BLOCKS;
 
     minithread_system_initialize(cache_test, NULL);
 
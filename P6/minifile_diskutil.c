@@ -41,8 +41,7 @@ minifile_remkfs(int *arg)
     iput(inode);
 
     sblock_print(mainsb);
-    printf("minifile system established on %s. ", disk_name);
-    printf("Hit ^C to quit minithread.\n");
+    printf("minifile system established on %s.\n", disk_name);
 
     return 0;
 }
@@ -123,7 +122,7 @@ minifile_fsck(int *arg)
         }
     }
     printf("Number of inconsistent blocks found: %d\n", error_count);
-    printf("File system check finishes. Hit ^C to quit minithread.\n");
+    printf("File system check finishes.\n");
 
     return 0;
 }
@@ -3,6 +3,16 @@
 #include "minithread.h"
 #include "minifile_fs.h"
 #include "minifile_diskutil.h"
+#include "minifile_cache.h"
+
+/* Check the file system, write every dirty block back and exit */
+static int
+fsck(int *arg)
+{
+    if (minifile_fsck(arg) != 0 || bsync() != 0)
+        exit(1);
+    exit(0);
+}
 
 int main(int argc, char** argv)
 {
@@ -10,7 +20,7 @@ int main(int argc, char** argv)
     disk_name = "minidisk";
     disk_flags = DISK_READWRITE;
 
-    minithread_system_initialize(minifile_fsck, NULL);
+    minithread_system_initialize(fsck, NULL);
 
     return 0;
 }
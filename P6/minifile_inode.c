@@ -39,13 +39,20 @@ static blocknum_t triple_indirect(disk_t* disk, blocknum_t blocknum, size_t bloc
 void
 ilock(mem_inode_t ino)
 {
-    semaphore_P(ino->inode_lock);
+    rwlock_wrlock(ino->inode_lock);
+}
+
+/* Lock an inode for reading, shared with other readers */
+void
+ilock_shared(mem_inode_t ino)
+{
+    rwlock_rdlock(ino->inode_lock);
 }
 
 void
 iunlock(mem_inode_t ino)
 {
-    semaphore_V(ino->inode_lock);
+    rwlock_unlock(ino->inode_lock);
 }
 
 /*
@@ -117,7 +124,7 @@ iget(disk_t* disk, inodenum_t n, mem_inode_t *inop)
 	blocknum_t block_to_read;
 	int sig = 0;
 
-	semaphore_P(itable_lock);
+	mutex_lock(itable_lock);
 
 	/* First find inode from table */
 	if (itable_get_from_table(n, inop) == 0) {
@@ -142,12 +149,6 @@ iget(disk_t* disk, inodenum_t n, mem_inode_t *inop)
 
 	memcpy((*inop), buf->data + INODE_OFFSET(n), sizeof(struct inode));
 
-	(*inop)->inode_lock = semaphore_new(1);
-	if (NULL == (*inop)->inode_lock) {
-        brelse(buf);
-        sig = -1;
-        goto ret;
-	}
 	(*inop)->disk = disk;
 	(*inop)->num = n;
 	(*inop)->buf = buf;
@@ -170,7 +171,7 @@ iget(disk_t* disk, inodenum_t n, mem_inode_t *inop)
 	brelse(buf);
 
 ret:
-    semaphore_V(itable_lock);
+    mutex_unlock(itable_lock);
     return sig;
 }
 
@@ -181,7 +182,7 @@ iput(mem_inode_t ino)
     if (NULL == ino)
         return;
 
-	semaphore_P(itable_lock);
+	mutex_lock(itable_lock);
 	ino->ref_count--;
 	if (ino->ref_count == 0) {
 		/* Delete this file */
@@ -198,7 +199,7 @@ iput(mem_inode_t ino)
 		itable_delete_from_table(ino);
 		itable_put_list(ino);
 	}
-	semaphore_V(itable_lock);
+	mutex_unlock(itable_lock);
 }
 
 /* Return the inode and update it on the disk */
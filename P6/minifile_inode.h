@@ -42,7 +42,7 @@ typedef struct mem_inode {
     blocknum_t double_indirect;
     blocknum_t triple_indirect;
 
-    semaphore_t inode_lock;     /* Read write lock */
+    rwlock_t inode_lock;        /* Read write lock */
     disk_t* disk;               /* Logic disk */
     inodenum_t num;             /* Inode number */
     buf_block_t buf;            /* Buffer cache containing this inode */
@@ -57,11 +57,13 @@ typedef struct mem_inode {
 	struct mem_inode* l_next;   /* Free list next */
 } *mem_inode_t;
 
-semaphore_t itable_lock;         /* Inode lock for iget and iput */
+mutex_t itable_lock;         /* Inode lock for iget and iput */
 struct inode _root_inode;       /* Root inode */
 mem_inode_t root_inode;         /* Root inode number */
 
+/* Lock an inode exclusively, or shared with other readers */
 extern void ilock(mem_inode_t ino);
+extern void ilock_shared(mem_inode_t ino);
 extern void iunlock(mem_inode_t ino);
 extern int iclear(mem_inode_t ino);
 extern void izero(mem_inode_t ino);
@@ -3,6 +3,16 @@
 #include "minithread.h"
 #include "minifile_fs.h"
 #include "minifile_diskutil.h"
+#include "minifile_cache.h"
+
+/* Make the file system, write every dirty block back and exit */
+static int
+mkfs(int *arg)
+{
+    if (minifile_remkfs(arg) != 0 || bsync() != 0)
+        exit(1);
+    exit(0);
+}
 
 int main(int argc, char** argv)
 {
@@ -15,7 +25,7 @@ int main(int argc, char** argv)
     disk_flags = DISK_READWRITE;
     disk_size = atoi(argv[1]);
 
-    minithread_system_initialize(minifile_remkfs, NULL);
+    minithread_system_initialize(mkfs, NULL);
 
     return 0;
 }
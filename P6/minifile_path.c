@@ -43,8 +43,9 @@ namei(char* path) {
 
 	pch = strtok(path_buf, "/");
 	while (pch != NULL) {
-		semaphore_P(working_inode->inode_lock);
+		ilock_shared(working_inode);
 		if (working_inode->type != MINIDIRECTORY || working_inode->status == TO_DELETE) {
+			iunlock(working_inode);
 			return 0;
 		}
 		entry_num = working_inode->size;
@@ -55,6 +56,7 @@ namei(char* path) {
 			existing_entry = (left_entry > ENTRY_NUM_PER_BLOCK ? ENTRY_NUM_PER_BLOCK : left_entry);
 			blocknum = blockmap(maindisk, working_inode, i);
 			if (bread(maindisk, blocknum, &buf) != 0) {
+				iunlock(working_inode);
 				return 0;
 			}
 			entry = (dir_entry_t)buf->data;
@@ -73,7 +75,7 @@ namei(char* path) {
 				break;
 			}
 		}
-		semaphore_V(working_inode->inode_lock);
+		iunlock(working_inode);
 		if (working_inode != root_inode) {
 			iput(working_inode);
 		}
@@ -124,8 +126,9 @@ nameinode(char* path, mem_inode_t ino) {
 
 	pch = strtok(path_buf, "/");
 	while (pch != NULL) {
-		semaphore_P(working_inode->inode_lock);
+		ilock_shared(working_inode);
 		if (working_inode->type != MINIDIRECTORY) {
+			iunlock(working_inode);
 			free(path_buf);
 			return 0;
 		}
@@ -137,6 +140,7 @@ nameinode(char* path, mem_inode_t ino) {
 			existing_entry = (left_entry > ENTRY_NUM_PER_BLOCK ? ENTRY_NUM_PER_BLOCK : left_entry);
 			blocknum = blockmap(maindisk, working_inode, i);
 			if (bread(maindisk, blocknum, &buf) != 0) {
+				iunlock(working_inode);
 				free(path_buf);
 				return 0;
 			}
@@ -156,7 +160,7 @@ nameinode(char* path, mem_inode_t ino) {
 				break;
 			}
 		}
-		semaphore_V(working_inode->inode_lock);
+		iunlock(working_inode);
 		if (working_inode != root_inode) {
 			iput(working_inode);
 		}
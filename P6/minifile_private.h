@@ -4,6 +4,16 @@
 #include "minifile_cache.h"
 #include "minifile_fs.h"
 
+/*
+ * Read-ahead. Reading the block after the one last read starts reading
+ * the next READAHEAD_MIN blocks in the background. Each time half of
+ * the blocks read ahead are used up, the window doubles, up to
+ * READAHEAD_MAX blocks. Any other read turns read-ahead off until
+ * reads are sequential again.
+ */
+#define READAHEAD_MIN 4
+#define READAHEAD_MAX 64
+
 /*
  * struct minifile:
  *     This is the structure that keeps the information about
@@ -17,6 +27,9 @@ struct minifile {
     int byte_cursor;
     int byte_in_block;
     char mode[3];
+    int ra_next;            /* Block a sequential read would read next */
+    int ra_end;             /* First block not read ahead */
+    int ra_window;          /* Blocks to read ahead, 0 when not sequential */
 };
 
 #endif /* __MINIFILE_PRIVATE_H__ */
@@ -2,6 +2,7 @@
 
 #include "disk.h"
 #include "minifile.h"
+#include "minifile_cache.h"
 #include "minifile_diskutil.h"
 
 #include "minithread.h"
@@ -11,6 +12,10 @@
 char file_create[] = "createfiletest";
 char file_open[] = "oepnfiletest";
 char file_read[] = "readfiletest";
+char file_readahead[] = "readaheadtest";
+
+/* Chunk of the sequential read, so reads straddle block boundaries */
+#define READAHEAD_CHUNK 1000
 
 char buf[BUFFER_SIZE];
 int num_threads = 10;
@@ -43,6 +48,48 @@ read_test(int *arg)
     return 0;
 }
 
+/*
+ * Read a file sequentially in chunks, each block holding its own pattern,
+ * and check that every block after the first was read ahead exactly once.
+ */
+int
+readahead_test()
+{
+    int i;
+    int n;
+    long before;
+    char local_buf[BUFFER_SIZE];
+    minifile_t file;
+
+    for (i = 0; i < BUFFER_SIZE; ++i) {
+        local_buf[i] = (i + i / DISK_BLOCK_SIZE) & 127;
+    }
+    file = minifile_open(file_readahead, "w+");
+    minifile_write(file, local_buf, BUFFER_SIZE);
+    minifile_close(file);
+
+    memset(local_buf, 0, BUFFER_SIZE);
+    before = bc->readahead;
+    file = minifile_open(file_readahead, "r");
+    for (i = 0; i < BUFFER_SIZE; i += n) {
+        n = minifile_read(file, local_buf + i, READAHEAD_CHUNK);
+        if (n <= 0)
+            break;
+    }
+    minifile_close(file);
+    for (i = 0; i < BUFFER_SIZE; ++i) {
+        if (local_buf[i] != ((i + i / DISK_BLOCK_SIZE) & 127)) {
+            printf("Read-ahead error at byte %d: %d.\n", i, local_buf[i]);
+            exit(1);
+        }
+    }
+    printf("Read %d blocks sequentially, %ld read ahead.\n",
+           BUFFER_SIZE / DISK_BLOCK_SIZE, bc->readahead - before);
+    if (bc->readahead - before != BUFFER_SIZE / DISK_BLOCK_SIZE - 1)
+        exit(1);
+    return 0;
+}
+
 int
 open_write_test(int *arg)
 {
@@ -75,6 +122,8 @@ file_test(int *arg)
     minifile_write(file,buf,BUFFER_SIZE);
     minifile_close(file);
 
+    readahead_test();
+
     printf("Forking read_test.\n");
     for (i = 0; i < num_threads; ++i) {
         minithread_fork(read_test, NULL);
@@ -63,13 +63,11 @@ miniport_create_unbound(int port_number)
         port[port_number]->type = UNBOUNDED;
         port[port_number]->num = port_number;
         port[port_number]->unbound.data = queue_new();
-        port[port_number]->unbound.ready = semaphore_create();
-        if (NULL == port[port_number]->unbound.data
-                || NULL == port[port_number]->unbound.ready) {
+        semaphore_initialize(&(port[port_number]->unbound.ready), 0);
+        if (NULL == port[port_number]->unbound.data) {
             miniport_destroy(port[port_number]);
             return NULL;
         }
-        semaphore_initialize(port[port_number]->unbound.ready, 0);
     }
     semaphore_V(port_mutex);
     return port[port_number];
@@ -143,7 +141,6 @@ miniport_destroy(miniport_t miniport)
     }
     if (UNBOUNDED == miniport->type) {
         queue_free(miniport->unbound.data);
-        semaphore_destroy(miniport->unbound.ready);
     }
     if (BOUNDED == miniport->type) {
         --bound_count;
@@ -229,7 +226,7 @@ minimsg_receive(miniport_t local_unbound_port, miniport_t* new_local_bound_port,
      * handler, so interrupts should be disabled here as well.
      */
     oldlevel = set_interrupt_level(DISABLED);
-    semaphore_P(local_unbound_port->unbound.ready);
+    semaphore_P(&(local_unbound_port->unbound.ready));
     queue_wrap_dequeue(local_unbound_port->unbound.data, (void**) &intrpt);
     set_interrupt_level(oldlevel);
 
@@ -278,7 +275,7 @@ minimsg_process(network_interrupt_arg_t *intrpt)
         set_interrupt_level(oldlevel);
         return -1;
     }
-    semaphore_V(port[port_num]->unbound.ready);
+    semaphore_V_io(&(port[port_num]->unbound.ready));
     set_interrupt_level(oldlevel);
 
     return 0;
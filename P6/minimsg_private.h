@@ -23,7 +23,7 @@ struct miniport {
     union {
         struct {
             queue_t data;
-            semaphore_t ready;
+            struct semaphore ready;
         } unbound;
         struct {
             network_address_t addr;
@@ -24,6 +24,9 @@ static void
 miniroute_pack_reply_hdr(miniroute_header_t hdr, int id, miniroute_path_t path);
 static void
 miniroute_pack_data_hdr(miniroute_header_t hdr, miniroute_path_t path);
+static int
+miniroute_route_lookup(network_address_t dest, miniroute_header_t hdr,
+                       network_address_t next_hop);
 static void
 miniroute_pack_hdr_from_path(miniroute_header_t hdr, miniroute_path_t path);
 static int
@@ -55,11 +58,13 @@ static semaphore_t discovery_sig;
 /* Result of discovery process */
 //static discovery_process_status_t discovery_status;
 /* Alarm for discovery timeout */
-static int discovery_alarm;
+static long discovery_alarm;
 /* Result of discovery process */
 static miniroute_path_t discovered_path;
 /* Routes cache*/
 static miniroute_cache_t route_cache;
+/* Protects route_cache, shared by senders looking routes up */
+static rwlock_t route_lock;
 /* Network discovery packets cache */
 static miniroute_cache_t disc_cache;
 /* Serial number of originating discovery packets */
@@ -75,16 +80,19 @@ miniroute_initialize()
     intrpt_sig = semaphore_create();
     discovery_mutex = semaphore_create();
     discovery_sig = semaphore_create();
+    route_lock = rwlock_create();
 
     route_cache = miniroute_cache_new(65536, SIZE_OF_ROUTE_CACHE, MINIROUTE_CACHED_ROUTE_EXPIRE);
     disc_cache = miniroute_cache_new(65536, SIZE_OF_ROUTE_CACHE, MINIROUTE_CACHED_ROUTE_EXPIRE * 10);
 
     if (NULL == intrpt_buffer || NULL == intrpt_sig || NULL == route_cache
-            || NULL == discovery_mutex || NULL == discovery_sig) {
+            || NULL == discovery_mutex || NULL == discovery_sig
+            || NULL == route_lock) {
         queue_free(intrpt_buffer);
         semaphore_destroy(intrpt_sig);
         semaphore_destroy(discovery_mutex);
         semaphore_destroy(discovery_sig);
+        rwlock_destroy(route_lock);
         miniroute_cache_destroy(route_cache);
         return;
     }
@@ -109,29 +117,34 @@ miniroute_send_pkt(network_address_t dest_address, int hdr_len, char* hdr,
     int sent_len = 0;
     struct routing_header routing_hdr;
     char *total_data = malloc(total_len);
-    miniroute_path_t path = NULL;
+    network_address_t next_hop;
+    int found;
 
     /* Find route if it is not in cache */
-    semaphore_P(discovery_mutex);
-    miniroute_cache_get_by_addr(route_cache,  dest_address, (void**)&path);
-
-    if (NULL == path || path->exp_time < ticks) {
+    found = miniroute_route_lookup(dest_address, &routing_hdr, next_hop);
+    if (0 == found) {
+        semaphore_P(discovery_mutex);
+        /* Another sender may have discovered it in the meantime */
+        found = miniroute_route_lookup(dest_address, &routing_hdr, next_hop);
+        if (0 == found) {
 #if MINIROUTE_CACHE_DEBUG == 1
-        printf("Address not found, discovering path.\n");
+            printf("Address not found, discovering path.\n");
 #endif
-        path = miniroute_discover_path(dest_address);
+            if (NULL != miniroute_discover_path(dest_address))
+                found = miniroute_route_lookup(dest_address, &routing_hdr, next_hop);
+        }
+        semaphore_V(discovery_mutex);
     }
 
-    semaphore_V(discovery_mutex);
-    if (NULL != path && NULL != (total_data = malloc(total_len))) {
+    if (found && NULL != total_data) {
         /* Pack data and miniroute header */
         memcpy(total_data, hdr, hdr_len);
         memcpy(total_data + hdr_len, data, data_len);
 
-        miniroute_pack_data_hdr(&routing_hdr, path);
-        sent_len = network_send_pkt(path->hop[1], MINIROUTE_HDRSIZE,
+        sent_len = network_send_pkt(next_hop, MINIROUTE_HDRSIZE,
                                     (char*)&routing_hdr, total_len, total_data);
     }
+    free(total_data);
 #if MINIROUTE_DEBUG == 1
     printf("Network packet sent.\n");
 #endif
@@ -187,6 +200,29 @@ miniroute_discovery_cancel()
     }
 }
 
+/*
+ * Look up an unexpired route to dest, holding the route cache shared. If
+ * found, pack the data header for it into hdr, copy the first hop into
+ * next_hop and return 1. Return 0 if not found.
+ */
+static int
+miniroute_route_lookup(network_address_t dest, miniroute_header_t hdr,
+                       network_address_t next_hop)
+{
+    miniroute_path_t path = NULL;
+    int found = 0;
+
+    rwlock_rdlock(route_lock);
+    miniroute_cache_get_by_addr(route_cache, dest, (void**)&path);
+    if (NULL != path && path->exp_time >= alarm_now()) {
+        miniroute_pack_data_hdr(hdr, path);
+        network_address_copy(path->hop[1], next_hop);
+        found = 1;
+    }
+    rwlock_unlock(route_lock);
+    return found;
+}
+
 /* Pack header for discovery packets */
 static void
 miniroute_pack_discovery_hdr(miniroute_header_t hdr, network_address_t dest)
@@ -240,7 +276,7 @@ miniroute_buffer_intrpt(network_interrupt_arg_t *intrpt)
     printf("Network packet received.\n");
 #endif
     if (queue_wrap_enqueue(intrpt_buffer, intrpt) == 0) {
-        semaphore_V(intrpt_sig);
+        semaphore_V_io(intrpt_sig);
         return 0;
     }
 
@@ -424,7 +460,9 @@ miniroute_process_discovery(network_interrupt_arg_t *intrpt)
         }
     } else {
         path = miniroute_path_from_hdr(hdr);
+        rwlock_wrlock(route_lock);
         miniroute_cache_put_item(route_cache, path);
+        rwlock_unlock(route_lock);
         miniroute_pack_reply_hdr(hdr, id, path);
 #if MINIROUTE_CACHE_DEBUG == 1
         printf("Processed discovery packet, replying with header: \n");
@@ -449,7 +487,9 @@ miniroute_process_reply(network_interrupt_arg_t *intrpt)
         miniroute_relay(intrpt);
     } else {
         discovered_path = miniroute_path_from_hdr(hdr);
+        rwlock_wrlock(route_lock);
         miniroute_cache_put_item(route_cache, (miniroute_item_t*)discovered_path);
+        rwlock_unlock(route_lock);
         free(intrpt);
         miniroute_discovery_cancel();
     }
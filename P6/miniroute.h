@@ -6,7 +6,7 @@
 #define MAX_ROUTE_LENGTH 20
 #define SIZE_OF_ROUTE_CACHE 20
 #define MINIROUTE_HDRSIZE (sizeof(struct routing_header))
-#define MINIROUTE_CACHED_ROUTE_EXPIRE (3 * (SECOND / PERIOD))
+#define MINIROUTE_CACHED_ROUTE_EXPIRE (3 * (SECOND / MILLISECOND))
 
 
 /* Address of local machine */
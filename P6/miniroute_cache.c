@@ -1,3 +1,4 @@
+#include "alarm.h"
 #include "miniroute_cache.h"
 #include "miniroute.h"
 #include "network.h"
@@ -5,8 +6,6 @@
 #include "miniheader.h"
 #include <stdlib.h>
 
-extern long ticks;
-
 /* Create a cache with size as table size, return NULL if fails */
 miniroute_cache_t
 miniroute_cache_new(int size, int max_num_entry, long exp_length)
@@ -116,7 +115,7 @@ miniroute_cache_put_item(miniroute_cache_t cache, void *it)
         cache->list_tail = item;
         cache->list_head = item;
     }
-    item->exp_time = ticks + cache->exp_length;
+    item->exp_time = alarm_now() + cache->exp_length;
 
     cache->item_num++;
     return 0;
@@ -198,7 +197,7 @@ miniroute_cache_set_max_num(miniroute_cache_t cache, int num)
 int
 miniroute_cache_is_expired(miniroute_item_t item)
 {
-    return item->exp_time >= ticks ? 0 : -1;
+    return item->exp_time >= alarm_now() ? 0 : -1;
 }
 
 /* Print whole cache, for debugging */
@@ -162,12 +162,12 @@ minisocket_server_create(int port, minisocket_error *error)
         return NULL;
     }
 
-    semaphore_P(minisocket[port]->state_mutex);
+    semaphore_P(&(minisocket[port]->state_mutex));
     do {
         minisocket[port]->state = LISTEN;
-        semaphore_V(minisocket[port]->state_mutex);
+        semaphore_V(&(minisocket[port]->state_mutex));
         /* Wait for SYN from client */
-        semaphore_P(minisocket[port]->synchonize);
+        semaphore_P(&(minisocket[port]->synchonize));
         /* Woke up by minisocket_process_syn */
         if (minisocket_get_state(minisocket[port]) == SYNRECEIVED)
             minisocket_transmit(minisocket[port], MSG_SYNACK, NULL, 0);
@@ -175,9 +175,9 @@ minisocket_server_create(int port, minisocket_error *error)
          * If a SYNACK is received, state would be set to ESTABLISHED
          * by the control thread.
          */
-        semaphore_P(minisocket[port]->state_mutex);
+        semaphore_P(&(minisocket[port]->state_mutex));
     } while (SYNRECEIVED== minisocket[port]->state);
-    semaphore_V(minisocket[port]->state_mutex);
+    semaphore_V(&(minisocket[port]->state_mutex));
 
     semaphore_P(port_count_mutex);
     socket_count++;
@@ -245,10 +245,10 @@ minisocket_client_create(network_address_t addr, int port,
     if (minisocket_common_init(port_num, error) == -1) {
         return NULL;
     }
-    semaphore_P(socket->state_mutex);
+    semaphore_P(&(socket->state_mutex));
     minisocket_client_init_from_input(addr, port, socket);
     socket->state = SYNSENT;
-    semaphore_V(minisocket[port_num]->state_mutex);
+    semaphore_V(&(minisocket[port_num]->state_mutex));
 
     /* Send SYN to server */
     if (minisocket_transmit(socket, MSG_SYN, NULL, 0) < 0) {
@@ -313,33 +313,21 @@ minisocket_common_init(int port, minisocket_error *error)
     socket->seq = 0;
     socket->ack = 0;
     socket->receive_count = 0;
-    socket->send_mutex = semaphore_create();
-    socket->data_mutex = semaphore_create();
-    socket->state_mutex = semaphore_create();
-    socket->seq_mutex = semaphore_create();
-    socket->synchonize = semaphore_create();
-    socket->retry = semaphore_create();
-    socket->receive = semaphore_create();
-    socket->receive_count_mutex = semaphore_create();
+    semaphore_initialize(&(socket->send_mutex), 1);
+    semaphore_initialize(&(socket->data_mutex), 1);
+    semaphore_initialize(&(socket->state_mutex), 1);
+    semaphore_initialize(&(socket->synchonize), 0);
+    semaphore_initialize(&(socket->retry), 0);
+    semaphore_initialize(&(socket->receive), 0);
+    semaphore_initialize(&(socket->seq_mutex), 0);
+    semaphore_initialize(&(socket->receive_count_mutex), 1);
     socket->data = queue_new();
-    if (NULL == socket->send_mutex || NULL == socket->synchonize
-            || NULL == socket->retry || NULL == socket->receive
-            || NULL == socket->data || NULL == socket->data_mutex
-            || NULL == socket->state_mutex || NULL == socket->seq_mutex
-            || NULL == socket->receive_count_mutex) {
+    if (NULL == socket->data) {
         minisocket[port] = NULL;
         *error = SOCKET_OUTOFMEMORY; /* Assume out of memory? */
         minisocket_cleanup_enqueue(socket);
         return -1;
     }
-    semaphore_initialize(socket->send_mutex, 1);
-    semaphore_initialize(socket->data_mutex, 1);
-    semaphore_initialize(socket->state_mutex, 1);
-    semaphore_initialize(socket->synchonize, 0);
-    semaphore_initialize(socket->retry, 0);
-    semaphore_initialize(socket->receive, 0);
-    semaphore_initialize(socket->seq_mutex, 0);
-    semaphore_initialize(socket->receive_count_mutex, 1);
     return 0;
 }
 
@@ -356,13 +344,6 @@ minisocket_destroy(minisocket_t *p_socket)
         while (queue_wrap_dequeue(socket->data, (void**)&intrpt) == 0)
             free(intrpt);
         queue_free(socket->data);
-        semaphore_destroy(socket->receive);
-        semaphore_destroy(socket->send_mutex);
-        semaphore_destroy(socket->data_mutex);
-        semaphore_destroy(socket->state_mutex);
-        semaphore_destroy(socket->seq_mutex);
-        semaphore_destroy(socket->synchonize);
-        semaphore_destroy(socket->retry);
         free(socket);
 
         semaphore_P(port_count_mutex);
@@ -405,12 +386,12 @@ minisocket_send(minisocket_t socket, minimsg_t msg, int len,
         return -1;
     }
 
-    semaphore_P(socket->send_mutex);
+    semaphore_P(&(socket->send_mutex));
     while (to_sent > 0) {
         state = minisocket_get_state(socket);
         if (state != ESTABLISHED) {
             *error = SOCKET_SENDERROR;
-            semaphore_V(socket->send_mutex);
+            semaphore_V(&(socket->send_mutex));
             return -1;
         }
 
@@ -423,13 +404,13 @@ minisocket_send(minisocket_t socket, minimsg_t msg, int len,
 
         if (sent < 0) {
             *error = SOCKET_SENDERROR;
-            semaphore_V(socket->send_mutex);
+            semaphore_V(&(socket->send_mutex));
             return -1;
         }
         total_sent += sent;
         to_sent -= sent;
     }
-    semaphore_V(socket->send_mutex);
+    semaphore_V(&(socket->send_mutex));
     return total_sent;
 }
 
@@ -462,21 +443,21 @@ minisocket_receive(minisocket_t socket, minimsg_t msg, int max_len,
         return -1;
     }
 
-    semaphore_P(socket->receive_count_mutex);
+    semaphore_P(&(socket->receive_count_mutex));
     state = minisocket_get_state(socket);
     if (state != ESTABLISHED) {
         *error = SOCKET_RECEIVEERROR;
-        semaphore_V(socket->receive_count_mutex);
+        semaphore_V(&(socket->receive_count_mutex));
         return -1;
     }
     socket->receive_count++;
-    semaphore_V(socket->receive_count_mutex);
+    semaphore_V(&(socket->receive_count_mutex));
 
-    semaphore_P(socket->receive);
+    semaphore_P(&(socket->receive));
 
-    semaphore_P(socket->receive_count_mutex);
+    semaphore_P(&(socket->receive_count_mutex));
     socket->receive_count--;
-    semaphore_V(socket->receive_count_mutex);
+    semaphore_V(&(socket->receive_count_mutex));
 
     while (1) {
         state = minisocket_get_state(socket);
@@ -484,9 +465,9 @@ minisocket_receive(minisocket_t socket, minimsg_t msg, int max_len,
             *error = SOCKET_RECEIVEERROR;
             return -1;
         }
-        semaphore_P(socket->data_mutex);
+        semaphore_P(&(socket->data_mutex));
         val = queue_wrap_dequeue(socket->data, (void**) &intrpt);
-        semaphore_V(socket->data_mutex);
+        semaphore_V(&(socket->data_mutex));
         if (val != 0) {
             break;
         }
@@ -509,7 +490,7 @@ minisocket_receive(minisocket_t socket, minimsg_t msg, int max_len,
             intrpt->size -= (max_len - stored_len);
             stored_len = max_len;
             queue_wrap_prepend(socket->data, intrpt);
-            semaphore_V(socket->receive);
+            semaphore_V(&(socket->receive));
             break;
         }
     }
@@ -528,20 +509,20 @@ minisocket_close(minisocket_t socket)
     if (socket == NULL) {
         return;
     }
-    semaphore_P(socket->state_mutex);
+    semaphore_P(&(socket->state_mutex));
     state = socket->state;
     if (state != ESTABLISHED) {
-        semaphore_V(socket->state_mutex);
+        semaphore_V(&(socket->state_mutex));
         return;
     }
     socket->state = LASTACK;
-    semaphore_V(socket->state_mutex);
+    semaphore_V(&(socket->state_mutex));
 
     minisocket_cleanup_prepare(socket);
 
-    semaphore_P(socket->send_mutex);
+    semaphore_P(&(socket->send_mutex));
     minisocket_transmit(socket, MSG_FIN, NULL, 0);
-    semaphore_V(socket->send_mutex);
+    semaphore_V(&(socket->send_mutex));
 
     semaphore_V(cleanup_sem);
     minisocket_cleanup_enqueue(socket);
@@ -571,11 +552,11 @@ static void
 minisocket_receive_unblock(minisocket_t socket)
 {
     int i;
-    semaphore_P(socket->receive_count_mutex);
+    semaphore_P(&(socket->receive_count_mutex));
     for (i = 0; i < socket->receive_count; i++) {
-        semaphore_V(socket->receive);
+        semaphore_V(&(socket->receive));
     }
-    semaphore_V(socket->receive_count_mutex);
+    semaphore_V(&(socket->receive_count_mutex));
 }
 
 /* Return -1 on failure, length of transmitted on success */
@@ -586,11 +567,11 @@ minisocket_transmit(minisocket_t socket, char msg_type, minimsg_t msg, int len)
     struct mini_header_reliable header;
     network_address_t remote;
 
-    semaphore_P(socket->state_mutex);
+    semaphore_P(&(socket->state_mutex));
     ++socket->seq;
     network_address_copy(socket->remote_addr, remote);
     minisocket_packhdr(&header, socket, msg_type);
-    semaphore_V(socket->state_mutex);
+    semaphore_V(&(socket->state_mutex));
 
     for (i = 0; i < MINISOCKET_MAX_TRY; ++i) {
         miniroute_send_pkt(remote, MINISOCKET_HDRSIZE, (char*)&header, len, msg);
@@ -634,7 +615,7 @@ minisocket_retry_wait(minisocket_t socket, int delay)
 {
     socket->alarm = register_alarm(delay, minisocket_retry_wakeup, socket);
 //printf("Registered alarm: %d\n", socket->alarm);
-    semaphore_P(socket->retry);
+    semaphore_P(&(socket->retry));
 }
 
 /* Wake the thread waiting on retry on 'socket' */
@@ -643,7 +624,7 @@ minisocket_retry_wakeup(void *socket)
 {
     minisocket_t skt = socket;
     skt->alarm = ALARM_WAKEUP;
-    semaphore_V(skt->retry);
+    semaphore_V(&(skt->retry));
 }
 
 /* Cancel retransmission */
@@ -654,7 +635,7 @@ minisocket_retry_cancel(minisocket_t socket, minisocket_alarm_status sig)
         deregister_alarm(socket->alarm);
 //printf("Deregistered alarm: %d\n", socket->alarm);
         socket->alarm = sig;
-        semaphore_V(socket->retry);
+        semaphore_V(&(socket->retry));
     }
 }
 
@@ -738,17 +719,17 @@ minisocket_cleanup(int *arg)
             semaphore_V(cleanup_queue_mutex);
 
             if (NULL != socket) {
-                semaphore_P(socket->receive_count_mutex);
+                semaphore_P(&(socket->receive_count_mutex));
 
                 if (socket->receive_count > 0) {
-                    semaphore_V(socket->receive_count_mutex);
+                    semaphore_V(&(socket->receive_count_mutex));
                     semaphore_V(cleanup_sem);
                     minisocket_receive_unblock(socket);
                     semaphore_P(cleanup_queue_mutex);
                     queue_wrap_enqueue(closing_sockets, socket);
                     semaphore_V(cleanup_queue_mutex);
                 } else {
-                    semaphore_V(socket->receive_count_mutex);
+                    semaphore_V(&(socket->receive_count_mutex));
                     minisocket_set_state(socket, CLOSED);
                     minisocket_destroy(&minisocket[socket->local_port_num]);
                 }
@@ -834,16 +815,16 @@ minisocket_process_syn(network_interrupt_arg_t *intrpt, minisocket_t local)
 #if (MINISOCKET_DEBUG == 1)
     printf("SYN received. State: %d.\n", local->state);
 #endif
-    semaphore_P(local->state_mutex);
+    semaphore_P(&(local->state_mutex));
     switch (local->state) {
     case LISTEN:
         local->state = SYNRECEIVED;
         minisocket_server_init_from_intrpt(intrpt, local);
-        semaphore_V(local->synchonize);
+        semaphore_V(&(local->synchonize));
         break;
     case SYNSENT:
         if (minisocket_validate_source(intrpt, local) == -1) {
-            semaphore_V(local->state_mutex);
+            semaphore_V(&(local->state_mutex));
             return INTERRUPT_PROCESSED;
         } else {
             local->ack = seq;
@@ -857,7 +838,7 @@ minisocket_process_syn(network_interrupt_arg_t *intrpt, minisocket_t local)
             minisocket_acknowledge(local);
         }
     }
-    semaphore_V(local->state_mutex);
+    semaphore_V(&(local->state_mutex));
 
     return INTERRUPT_PROCESSED;
 }
@@ -887,7 +868,7 @@ minisocket_process_ack(network_interrupt_arg_t *intrpt, minisocket_t local)
     if (minisocket_validate_source(intrpt, local) == -1)
         return INTERRUPT_PROCESSED;
 
-    semaphore_P(local->state_mutex);
+    semaphore_P(&(local->state_mutex));
     /* The packet acknowledges previously sent packet. */
     if (local->seq == ack) {
         if (local->alarm > -1) {
@@ -922,20 +903,20 @@ minisocket_process_ack(network_interrupt_arg_t *intrpt, minisocket_t local)
     /* Store the packet that has not been seen before */
     if (ESTABLISHED == local->state && local->ack + 1 == seq) {
         /* Enqueue data and signal the thread waiting for data */
-        semaphore_P(local->data_mutex);
+        semaphore_P(&(local->data_mutex));
         if (queue_wrap_enqueue(local->data, intrpt) == 0) {
             if (queue_length(local->data) == 1) {
-                semaphore_V(local->receive);
+                semaphore_V_io(&(local->receive));
                 /* Acknowlege data received */
                 local->ack++;
                 minisocket_acknowledge(local);
-                semaphore_V(local->state_mutex);
+                semaphore_V(&(local->state_mutex));
                 intrpt_status = INTERRUPT_STORED;
             }
         }
-        semaphore_V(local->data_mutex);
+        semaphore_V(&(local->data_mutex));
     }
-    semaphore_V(local->state_mutex);
+    semaphore_V(&(local->state_mutex));
 
     return intrpt_status;
 }
@@ -952,7 +933,7 @@ minisocket_process_fin(network_interrupt_arg_t *intrpt, minisocket_t local)
     if (minisocket_validate_source(intrpt, local) == -1)
         return INTERRUPT_PROCESSED;
 
-    semaphore_P(local->state_mutex);
+    semaphore_P(&(local->state_mutex));
     switch (local->state) {
     case SYNSENT:
         local->state = TIMEWAIT;
@@ -985,7 +966,7 @@ minisocket_process_fin(network_interrupt_arg_t *intrpt, minisocket_t local)
     default:
         ;
     }
-    semaphore_V(local->state_mutex);
+    semaphore_V(&(local->state_mutex));
 
     return INTERRUPT_PROCESSED;
 }
@@ -994,16 +975,16 @@ static int
 minisocket_get_state(minisocket_t socket)
 {
     int state;
-    semaphore_P(socket->state_mutex);
+    semaphore_P(&(socket->state_mutex));
     state = socket->state;
-    semaphore_V(socket->state_mutex);
+    semaphore_V(&(socket->state_mutex));
     return state;
 }
 
 static void
 minisocket_set_state(minisocket_t socket, int state)
 {
-    semaphore_P(socket->state_mutex);
+    semaphore_P(&(socket->state_mutex));
     socket->state = state;
-    semaphore_V(socket->state_mutex);
+    semaphore_V(&(socket->state_mutex));
 }
@@ -33,17 +33,17 @@ struct minisocket {
     network_address_t local_addr;
     int seq;
     int ack;
-    minisocket_alarm_status alarm;
+    long alarm;                   /* Alarm id, or a minisocket_alarm_status */
     int receive_count;
     queue_t data;
-    semaphore_t send_mutex; /* send mutex: only one thread can send */
-    semaphore_t data_mutex; /* data queue */
-    semaphore_t state_mutex; /* socket state */
-    semaphore_t seq_mutex;   /* sequence number mutex */
-    semaphore_t receive_count_mutex; /* receive count mutex */
-    semaphore_t synchonize;
-    semaphore_t retry;
-    semaphore_t receive;
+    struct semaphore send_mutex; /* send mutex: only one thread can send */
+    struct semaphore data_mutex; /* data queue */
+    struct semaphore state_mutex; /* socket state */
+    struct semaphore seq_mutex;   /* sequence number mutex */
+    struct semaphore receive_count_mutex; /* receive count mutex */
+    struct semaphore synchonize;
+    struct semaphore retry;
+    struct semaphore receive;
     enum socket_state {
         LISTEN,
         SYNSENT,
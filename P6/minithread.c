@@ -11,9 +11,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <string.h>
 
 #include "alarm.h"
 #include "interrupts.h"
+#include "interrupts_private.h"
 #include "minifile_cache.h"
 #include "minifile_inode.h"
 #include "minifile_inodetable.h"
@@ -23,6 +25,7 @@
 #include "minisocket.h"
 #include "network.h"
 #include "queue.h"
+#include "random.h"
 #include "read_private.h"
 #include "synch.h"
 #include "minithread.h"
@@ -48,20 +51,39 @@ static unsigned int tid_count;
 static minithread_t context;
 /* Pointer to the ready queue */
 static multilevel_queue_t ready;
-/* Pointer to the exited thread queue */
-static queue_t exited;
 /* Time when current running thread is scheduled to be switch out */
 static long expire;
+/* Total tickets of the threads on the ready queue, and on each level */
+static long ready_tickets;
+static long level_tickets[MAX_SCHED_PRIORITY + 1];
+/* Pass of the last thread picked under the stride policy */
+static long stride_pass;
+/* Heap of the ready threads by pass, kept under the stride policy */
+static minithread_t stride_heap;
+/* List of all threads, linked through all_next */
+static minithread_t all_threads;
+/* Exited thread to release once the host has switched off its stack */
+static minithread_t zombie;
+/* Released control blocks kept for reuse, linked through all_next */
+static minithread_t tcb_pool;
+/* Number of control blocks in tcb_pool */
+static int tcb_pool_len;
 /* The quanta limit for each priority level */
 static int quanta_lim[MAX_SCHED_PRIORITY + 1];
-/* Semaphore for counting exited threads */
-static semaphore_t exit_count;
-/* Semaphore for atomically operating on the exited queue */
-static semaphore_t exit_mutex;
-/* Semaphore for atomically operating on thread counters */
-static semaphore_t id_mutex;
-
-/* Pointer to the idle thread */
+/* Share of multilevel picks, out of 160, that start at each level */
+static const int level_share[MAX_SCHED_PRIORITY + 1] = { 80, 40, 24, 16 };
+/* Time of the next aging of the ready queues */
+static long aging_time;
+/* Milliseconds the host has spent parked in the idle loop */
+static uint64_t idle_time;
+/* Thread-specific data keys in use */
+static char key_used[MINITHREAD_KEYS_MAX];
+/* Destructors of the thread-specific data keys */
+static void (*key_destructor[MINITHREAD_KEYS_MAX])(void*);
+/* Set once the boot thread no longer blocks in file system initialization */
+static int fs_initialized;
+
+/* Idle thread, running on the initial host stack */
 static struct minithread _idle_thread_;
 static minithread_t const idle_thread = &_idle_thread_;
 
@@ -78,12 +100,28 @@ extern long alarm_time;
 /* File scope functions, explained below */
 static void minithread_schedule();
 static minithread_t minithread_picknew();
+static int pick_multilevel(minithread_t *tp);
+static int pick_lottery(minithread_t *tp);
+static int pick_stride(minithread_t *tp);
+static int lottery_draw(void *arg, void *item);
+static minithread_t stride_merge(minithread_t a, minithread_t b);
+static int stride_insert(void *arg, void *item);
+static void minithread_ready(minithread_t t);
+static void minithread_preempt();
+static void minithread_age();
+static void minithread_key_destroy(minithread_t t);
+static int minithread_idle(arg_t arg);
+static void minithread_idle_wait();
+static int minithread_runnable();
+static int minithread_body(arg_t arg);
 static int minithread_exit(arg_t arg);
-static int minithread_cleanup();
+static void minithread_free(minithread_t t);
+static void minithread_reap();
+static void minithread_link(minithread_t t);
+static void minithread_unlink(minithread_t t);
 static int minithread_initialize_scheduler();
 static int minithread_initialize_sys_threads();
 static int minithread_initialize_interrupts();
-static int minithread_initialize_sys_sems();
 static int minithread_initialize_diskio();
 static int minithread_initialize_filesystem();
 static int minithread_fs_init_idle(int *arg);
@@ -91,6 +129,24 @@ static void clock_handler(void* arg);
 static void network_handler(void* arg);
 static void disk_handler(void* arg);
 
+/*
+ * Scheduling policies, indexed by sched_policy_t.
+ * pick: dequeue the next thread from the ready queue.
+ * Return the level whose quanta the thread gets, or -1 if none is ready.
+ */
+struct sched_policy {
+    int (*pick)(minithread_t *tp);
+};
+
+static const struct sched_policy policies[] = {
+    { pick_multilevel },
+    { pick_lottery },
+    { pick_stride }
+};
+
+/* Policy in use */
+static const struct sched_policy *policy = &policies[SCHED_MULTILEVEL];
+
 /* minithread functions */
 
 /*
@@ -99,71 +155,141 @@ static void disk_handler(void* arg);
  */
 minithread_t
 minithread_create(proc_t proc, arg_t arg)
+{
+    return minithread_create_ex(proc, arg, 0);
+}
+
+/*
+ * Allocate memory and initialize a thread with a stack of at least
+ * stacksize bytes, or the default size if stacksize is 0.
+ * Return NULL when allocation fails.
+ */
+minithread_t
+minithread_create_ex(proc_t proc, arg_t arg, size_t stacksize)
 {
     minithread_t t;
+    interrupt_level_t oldlevel;
 
-    /* Allocate memory for TCB and stack. */
-    if ((t = malloc(sizeof(struct minithread))) == NULL) {
-        return NULL;
+    if (0 == stacksize)
+        stacksize = DEFAULT_STACKSIZE;
+
+    /* Reuse a released TCB, or allocate one. */
+    oldlevel = set_interrupt_level(DISABLED);
+    if (NULL != (t = tcb_pool)) {
+        tcb_pool = t->all_next;
+        --tcb_pool_len;
     }
-    minithread_allocate_stack(&(t->base), &(t->top));
-    if (NULL == t->base || NULL == t->top) {
-        free(t);
-        return NULL;
+    set_interrupt_level(oldlevel);
+    if (NULL == t) {
+        if ((t = malloc(sizeof(struct minithread))) == NULL)
+            return NULL;
     }
+    semaphore_initialize(&(t->sleep_sem), 0);
 
-    /* Initialize sleep semaphore */
-    t->sleep_sem = semaphore_create();
-    if (NULL == t->sleep_sem) {
-        minithread_free_stack(t->base);
+    /* Allocate the stack. */
+    t->stacksize = stacksize;
+    minithread_allocate_stack_size(&(t->base), &(t->top), t->stacksize);
+    if (NULL == t->base || NULL == t->top) {
         free(t);
         return NULL;
     }
-    semaphore_initialize(t->sleep_sem, 0);
 
     /* Initialize TCB and thread stack. */
-    minithread_initialize_stack(&(t->top), proc, arg, minithread_exit, NULL);
+    minithread_initialize_stack(&(t->top), minithread_body, (arg_t) t,
+                                minithread_exit, NULL);
+    t->proc = proc;
+    t->arg = arg;
+    t->result = 0;
+    t->joinable = 0;
+    t->joined = 0;
     t->qnode.prev = NULL;
     t->qnode.next = NULL;
     t->status = INITIAL;
     t->priority = 0;
+    t->tickets = DEFAULT_TICKETS;
+    t->pass = 0;
+    t->stamp = ticks;
+    t->run_ticks = 0;
+    t->wait_ticks = 0;
+    t->voluntary = 0;
+    t->involuntary = 0;
+    t->demotions = 0;
+    memset(t->specific, 0, sizeof(t->specific));
     t->current_dir = mainsb->root_inum;
 	t->current_dir_inode = root_inode;
 
-    semaphore_P(id_mutex);
+    oldlevel = set_interrupt_level(DISABLED);
     t->id = tid_count;
     ++tid_count;
     ++thd_count;
-    semaphore_V(id_mutex);
+    set_interrupt_level(oldlevel);
+    minithread_link(t);
 
     return t;
 }
 
+/* Add thread t to the list of all threads */
+static void
+minithread_link(minithread_t t)
+{
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    t->all_prev = NULL;
+    t->all_next = all_threads;
+    if (NULL != all_threads)
+        all_threads->all_prev = t;
+    all_threads = t;
+    set_interrupt_level(oldlevel);
+}
+
+/* Remove thread t from the list of all threads */
+static void
+minithread_unlink(minithread_t t)
+{
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    if (NULL != t->all_prev)
+        t->all_prev->all_next = t->all_next;
+    else
+        all_threads = t->all_next;
+    if (NULL != t->all_next)
+        t->all_next->all_prev = t->all_prev;
+    set_interrupt_level(oldlevel);
+}
+
 /*
- * Thread to release memory of exited threads.
+ * Release the control block and stack of exited thread t. Keep the
+ * control block for reuse unless tcb_pool is full.
  */
-static int
-minithread_cleanup(arg_t arg)
+static void
+minithread_free(minithread_t t)
 {
-    minithread_t t = NULL;
-    interrupt_level_t oldlevel;
-    while (1) {
-        oldlevel = set_interrupt_level(DISABLED);
-        semaphore_P(exit_count);
-        set_interrupt_level(oldlevel);
-        semaphore_P(id_mutex);
-        --thd_count;
-        semaphore_V(id_mutex);
-        semaphore_P(exit_mutex);
-        queue_dequeue(exited, (void**) &t);
-        if (t != NULL) {
-            minithread_free_stack(t->base);
-            semaphore_destroy(t->sleep_sem);
-            free(t);
-        }
-        semaphore_V(exit_mutex);
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    --thd_count;
+    minithread_unlink(t);
+    minithread_free_stack_size(t->base, t->stacksize);
+    if (tcb_pool_len < TCB_POOL_MAX) {
+        t->all_next = tcb_pool;
+        tcb_pool = t;
+        ++tcb_pool_len;
+    } else {
+        free(t);
     }
-    return 0;
+    set_interrupt_level(oldlevel);
+}
+
+/*
+ * Release the thread that exited last, if any. Called on the way out of
+ * a context switch, when the host is no longer on the stack of that
+ * thread.
+ */
+static void
+minithread_reap()
+{
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    minithread_t t = zombie;
+    zombie = NULL;
+    if (NULL != t)
+        minithread_free(t);
+    set_interrupt_level(oldlevel);
 }
 
 /* Add thread t to the end of the appropriate ready queue. */
@@ -175,7 +301,11 @@ minithread_start(minithread_t t)
         return;
     oldlevel = set_interrupt_level(DISABLED);
     t->status = READY;
-    multilevel_queue_enqueue(ready, t->priority, t);
+    t->stamp = ticks;
+    /* Do not let a thread that has been away catch up on passes it missed */
+    if (t->pass < stride_pass)
+        t->pass = stride_pass;
+    minithread_ready(t);
     set_interrupt_level(oldlevel);
 }
 
@@ -192,19 +322,40 @@ minithread_stop()
     set_interrupt_level(oldlevel);
 }
 
+/* Run the proc of thread arg and keep its result for minithread_join */
+static int
+minithread_body(arg_t arg)
+{
+    minithread_t t = (minithread_t) arg;
+    if (NULL != zombie)
+        minithread_reap();
+    interrupt_replay_deferred();
+    t->result = t->proc(t->arg);
+    return t->result;
+}
+
 /*
  * This is the 'final_proc' that helps threads exit properly.
+ * A joinable thread is left for minithread_join to release. Any other
+ * thread is released by the next thread to run, once the host is off
+ * its stack.
  */
 static int
 minithread_exit(arg_t arg)
 {
     interrupt_level_t oldlevel;
-    semaphore_P(exit_mutex);
-    queue_append(exited, context);
-    semaphore_V(exit_mutex);
+    minithread_t t = context;
+    minithread_key_destroy(t);
     oldlevel = set_interrupt_level(DISABLED);
-    semaphore_V(exit_count);
-    context->status = EXITED;
+    t->status = EXITED;
+    if (t->joinable) {
+        semaphore_V(&(t->join_sem));
+    } else {
+        /* The previous zombie may not have been reaped yet */
+        if (NULL != zombie)
+            minithread_free(zombie);
+        zombie = t;
+    }
     minithread_schedule();
     /*
      * The thread is switched out before this step,
@@ -222,16 +373,18 @@ minithread_exit(arg_t arg)
 void
 minithread_yield()
 {
-    minithread_t t = context;
     interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    minithread_t t = context;
     t->status = READY;
     /* Reduce its privilige if t runs out of quanta */
     if (ticks >= expire) {
-        if (t->priority < MAX_SCHED_PRIORITY)
+        if (t->priority < MAX_SCHED_PRIORITY) {
             ++t->priority;
+            ++t->demotions;
+        }
     }
     if (t != idle_thread) {
-        multilevel_queue_enqueue(ready, t->priority, t);
+        minithread_ready(t);
     }
     minithread_schedule();
     set_interrupt_level(oldlevel);
@@ -240,8 +393,71 @@ minithread_yield()
 /* Create and start a thread. */
 minithread_t
 minithread_fork(proc_t proc, arg_t arg)
+{
+    return minithread_fork_ex(proc, arg, 0);
+}
+
+/* Create and start a joinable thread. */
+minithread_t
+minithread_fork_joinable(proc_t proc, arg_t arg)
 {
     minithread_t t = minithread_create(proc, arg);
+    if (NULL == t)
+        return NULL;
+    semaphore_initialize(&(t->join_sem), 0);
+    t->joinable = 1;
+    minithread_start(t);
+    return t;
+}
+
+/* Wait for joinable thread t to exit and release it */
+int
+minithread_join(minithread_t t, int *result)
+{
+    interrupt_level_t oldlevel;
+    if (NULL == t || t == context)
+        return -1;
+    oldlevel = set_interrupt_level(DISABLED);
+    if (!t->joinable || t->joined) {
+        set_interrupt_level(oldlevel);
+        return -1;
+    }
+    t->joined = 1;
+    set_interrupt_level(oldlevel);
+    /* t has been switched out for good once this returns */
+    semaphore_P(&(t->join_sem));
+    if (NULL != result)
+        *result = t->result;
+    minithread_free(t);
+    return 0;
+}
+
+/* Detach joinable thread t, releasing it if it has exited */
+int
+minithread_detach(minithread_t t)
+{
+    interrupt_level_t oldlevel;
+    int zombie;
+    if (NULL == t)
+        return -1;
+    oldlevel = set_interrupt_level(DISABLED);
+    if (!t->joinable || t->joined) {
+        set_interrupt_level(oldlevel);
+        return -1;
+    }
+    t->joinable = 0;
+    zombie = (EXITED == t->status);
+    set_interrupt_level(oldlevel);
+    if (zombie)
+        minithread_free(t);
+    return 0;
+}
+
+/* Create and start a thread with a stack of at least stacksize bytes. */
+minithread_t
+minithread_fork_ex(proc_t proc, arg_t arg, size_t stacksize)
+{
+    minithread_t t = minithread_create_ex(proc, arg, stacksize);
     if (NULL == t)
         return NULL;
     minithread_start(t);
@@ -255,47 +471,368 @@ static void
 minithread_schedule()
 {
     minithread_t rt_old = context;
-    minithread_t rt_new;
-    /* Determine the next thread to run. NULL if there is no ready thread. */
-    if ((rt_new = minithread_picknew()) == NULL)
-        return;
+    /* Determine the next thread to run. */
+    minithread_picknew();
+    if (rt_old != context)
+        ++rt_old->voluntary;
     /* Switch only when the threads are different. */
-    if (rt_old != rt_new)
-        minithread_switch(&(rt_old->top),&(rt_new->top));
+    if (rt_old != context) {
+        interrupt_disabled_end();
+        minithread_switch(&(rt_old->top), &(context->top));
+        if (NULL != zombie)
+            minithread_reap();
+        interrupt_replay_deferred();
+    }
 }
 
 /*
  * Return the pointer to the next thread to run.
  * Return idle_thread if there is no other thread to run.
- * Set up the new thread with its expiration time, status and context pointer.
+ * Set up the new thread with its expiration time, status and context pointer,
+ * and charge the time since their last change to the old and new threads.
  */
 static minithread_t
 minithread_picknew()
 {
     minithread_t t;
-    int r = ticks % 160;
-    int p;
-    /* Determine how many quanta to assign to the next thread */
-    if (r < 80)
-        p = 0;
-    else if (r < 120)
-        p = 1;
-    else if (r < 144)
-        p = 2;
-    else
-        p = 3;
+    int lvl;
+    if (NULL != context) {
+        context->run_ticks += ticks - context->stamp;
+        context->stamp = ticks;
+    }
     /* Look for a ready thread, or switch to idle_thread */
-    if (multilevel_queue_dequeue(ready, p, (void**) &t) > -1) {
-        expire = ticks + quanta_lim[p];
+    if ((lvl = policy->pick(&t)) > -1) {
+        expire = ticks + quanta_lim[lvl];
+        minithread_clock_arm(expire);
     } else {
         t = idle_thread;
-        expire = ticks + 1;
+        expire = ticks + QUANTUM;
     }
+    if (READY == t->status)
+        t->wait_ticks += ticks - t->stamp;
+    t->stamp = ticks;
     context = t;
     t->status = RUNNING;
     return t;
 }
 
+/*
+ * Multilevel feedback policy. Start looking at a level chosen by the
+ * clock in proportion to level_share, and give the thread the quanta of
+ * that level.
+ */
+static int
+pick_multilevel(minithread_t *tp)
+{
+    int r = (ticks / QUANTUM) % 160;
+    int lvl = 0;
+    int cur;
+    while (lvl < MAX_SCHED_PRIORITY && r >= level_share[lvl])
+        r -= level_share[lvl++];
+    if ((cur = multilevel_queue_dequeue(ready, lvl, (void**) tp)) == -1)
+        return -1;
+    ready_tickets -= (*tp)->tickets;
+    level_tickets[cur] -= (*tp)->tickets;
+    /* The thread may have been aged to a higher level than its priority */
+    (*tp)->priority = cur;
+    return lvl;
+}
+
+/* State of a lottery drawing over the ready queue */
+struct lottery {
+    long draw;
+    minithread_t winner;
+};
+
+/*
+ * Lottery policy. Draw a ticket among all ready threads,
+ * so each thread is picked in proportion to its tickets. The totals of
+ * the queue and of each level are kept as threads come and go, so the
+ * draw finds the level of the winner at once and only walks that level.
+ */
+static int
+pick_lottery(minithread_t *tp)
+{
+    struct lottery l;
+    int lvl = 0;
+    if (0 == ready_tickets)
+        return -1;
+    l.draw = genintrand(ready_tickets) - 1;
+    while (l.draw >= level_tickets[lvl])
+        l.draw -= level_tickets[lvl++];
+    l.winner = NULL;
+    multilevel_queue_iterate_level(ready, lvl, lottery_draw, &l);
+    *tp = l.winner;
+    ready_tickets -= (*tp)->tickets;
+    level_tickets[lvl] -= (*tp)->tickets;
+    return (*tp)->priority = multilevel_queue_delete(ready, *tp);
+}
+
+/* Find the winner of the draw */
+static int
+lottery_draw(void *arg, void *item)
+{
+    struct lottery *l = arg;
+    minithread_t t = item;
+    if (l->draw < t->tickets) {
+        l->winner = t;
+        return -1;
+    }
+    l->draw -= t->tickets;
+    return 0;
+}
+
+/*
+ * Stride policy. Pick the ready thread with the smallest pass, the root
+ * of the heap, then advance its pass by its stride,
+ * inversely proportional to its tickets.
+ */
+static int
+pick_stride(minithread_t *tp)
+{
+    minithread_t t = stride_heap;
+    if (NULL == t)
+        return -1;
+    stride_heap = stride_merge(t->stride_left, t->stride_right);
+    ready_tickets -= t->tickets;
+    stride_pass = t->pass;
+    t->pass += STRIDE1 / t->tickets;
+    *tp = t;
+    t->priority = multilevel_queue_delete(ready, t);
+    level_tickets[t->priority] -= t->tickets;
+    return t->priority;
+}
+
+/*
+ * Merge the leftist heaps a and b, ordered by pass, and return the root.
+ * The right spines are O(log n) long, and so is the recursion.
+ */
+static minithread_t
+stride_merge(minithread_t a, minithread_t b)
+{
+    minithread_t t;
+    if (NULL == a)
+        return b;
+    if (NULL == b)
+        return a;
+    if (b->pass < a->pass) {
+        t = a;
+        a = b;
+        b = t;
+    }
+    a->stride_right = stride_merge(a->stride_right, b);
+    if (NULL == a->stride_left
+            || a->stride_left->stride_rank < a->stride_right->stride_rank) {
+        t = a->stride_left;
+        a->stride_left = a->stride_right;
+        a->stride_right = t;
+    }
+    a->stride_rank = (NULL == a->stride_right)
+                     ? 1 : a->stride_right->stride_rank + 1;
+    return a;
+}
+
+/* Add ready thread item to the heap */
+static int
+stride_insert(void *arg, void *item)
+{
+    minithread_t t = item;
+    t->stride_left = NULL;
+    t->stride_right = NULL;
+    t->stride_rank = 1;
+    stride_heap = stride_merge(stride_heap, t);
+    return 0;
+}
+
+/*
+ * Put thread t on the ready queue, counting its tickets and adding it to
+ * the heap under the stride policy. Interrupts should be disabled.
+ */
+static void
+minithread_ready(minithread_t t)
+{
+    multilevel_queue_enqueue(ready, t->priority, t);
+    ready_tickets += t->tickets;
+    level_tickets[t->priority] += t->tickets;
+    if (&policies[SCHED_STRIDE] == policy)
+        stride_insert(NULL, t);
+}
+
+/* Select the scheduling policy */
+void
+minithread_set_policy(sched_policy_t p)
+{
+    interrupt_level_t oldlevel;
+    if (p < SCHED_MULTILEVEL || p > SCHED_STRIDE)
+        return;
+    oldlevel = set_interrupt_level(DISABLED);
+    policy = &policies[p];
+    /* The heap is only kept under stride; build it from the queue */
+    stride_heap = NULL;
+    if (&policies[SCHED_STRIDE] == policy)
+        multilevel_queue_iterate(ready, stride_insert, NULL);
+    set_interrupt_level(oldlevel);
+}
+
+/* Set the number of tickets of thread t */
+void
+minithread_set_tickets(minithread_t t, int tickets)
+{
+    interrupt_level_t oldlevel;
+    int lvl;
+    if (NULL == t || tickets <= 0)
+        return;
+    oldlevel = set_interrupt_level(DISABLED);
+    if (READY == t->status && (lvl = multilevel_queue_level(ready, t)) > -1) {
+        ready_tickets += tickets - t->tickets;
+        level_tickets[lvl] += tickets - t->tickets;
+    }
+    t->tickets = tickets;
+    set_interrupt_level(oldlevel);
+}
+
+/*
+ * Clock driven preemption. Requeue the running thread if it has used up
+ * its quanta, and arm the clock for the expiry of the thread to run.
+ * Alarms arm the clock themselves. Interrupts should be disabled.
+ */
+static void
+minithread_preempt()
+{
+    minithread_t rt_old = context;
+    if (ticks >= expire) {
+        rt_old->status = READY;
+        if (rt_old != idle_thread) {
+            if (rt_old->priority < MAX_SCHED_PRIORITY) {
+                ++rt_old->priority;
+                ++rt_old->demotions;
+            }
+            minithread_ready(rt_old);
+        }
+        minithread_picknew();
+        if (rt_old != context)
+            ++rt_old->involuntary;
+    }
+    if (context != idle_thread)
+        minithread_clock_arm(expire);
+    if (rt_old != context) {
+        interrupt_disabled_end();
+        minithread_switch(&(rt_old->top), &(context->top));
+        if (NULL != zombie)
+            minithread_reap();
+    }
+}
+
+/*
+ * Raise the threads waiting on the ready queue one priority level, so
+ * threads demoted by a burst of computation regain a short latency.
+ * The priority of an aged thread is updated when it is picked. Each level
+ * is raised onto the one emptied just before, except level 1 onto level
+ * 0, so only the shorter of levels 0 and 1 is relinked.
+ * Interrupts should be disabled.
+ */
+static void
+minithread_age()
+{
+    int lvl;
+    for (lvl = 1; lvl <= MAX_SCHED_PRIORITY; ++lvl) {
+        multilevel_queue_raise(ready, lvl);
+        level_tickets[lvl - 1] += level_tickets[lvl];
+        level_tickets[lvl] = 0;
+    }
+    aging_time = ticks + AGING_PERIOD;
+}
+
+/* Raise thread t to the highest priority */
+void
+minithread_boost(minithread_t t)
+{
+    if (NULL != t)
+        t->priority = 0;
+}
+
+/* Idle loop */
+static int
+minithread_idle(arg_t arg)
+{
+    while (1)
+        minithread_idle_wait();
+    return 0;
+}
+
+/*
+ * Park the host until the next alarm or interrupt if no thread can run,
+ * then let the scheduler pick a thread. The clock runs on processor time
+ * and stands still while the host is parked, so the time spent parked is
+ * credited to ticks and the alarms that came due are fired here. Device
+ * interrupts cannot be taken while parked; they wake the host and are
+ * replayed when interrupts are enabled below.
+ */
+static void
+minithread_idle_wait()
+{
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    uint64_t start;
+    uint64_t elapsed;
+    long now;
+    long timeout = -1;
+    if (!minithread_runnable()) {
+        if (alarm_time > -1) {
+            now = alarm_now();
+            timeout = (alarm_time > now) ? alarm_time - now : 0;
+        }
+        /* Any device interrupt interrupts the wait */
+        interrupt_disabled_end();
+        start = currentTimeMillis();
+        interrupt_park(timeout);
+        elapsed = currentTimeMillis() - start;
+        idle_time += elapsed;
+        minithread_clock_advance(elapsed);
+        if (alarm_time > -1)
+            alarm_signal();
+    }
+    set_interrupt_level(oldlevel);
+    minithread_yield();
+}
+
+/*
+ * Return 1 if a thread other than the idle thread is ready, 0 otherwise.
+ * Interrupts should be disabled.
+ */
+static int
+minithread_runnable()
+{
+    return multilevel_queue_length(ready) > 0;
+}
+
+/* Return the time in milliseconds the host has spent parked when idle */
+uint64_t
+minithread_idle_time()
+{
+    return idle_time;
+}
+
+/* Print the scheduling counters of every thread */
+void
+minithread_stats()
+{
+    static const char *status_name[] = {
+        "INITIAL", "RUNNING", "READY", "BLOCKED", "EXITED"
+    };
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    minithread_t t;
+    printf("%5s %-8s %4s %8s %8s %8s %8s %7s\n", "id", "status", "prio",
+           "run", "wait", "vol", "invol", "demote");
+    for (t = all_threads; NULL != t; t = t->all_next) {
+        printf("%5u %-8s %4d %8ld %8ld %8u %8u %7u\n", t->id,
+               status_name[t->status], t->priority,
+               t->run_ticks + (RUNNING == t->status ? ticks - t->stamp : 0),
+               t->wait_ticks + (READY == t->status ? ticks - t->stamp : 0),
+               t->voluntary, t->involuntary, t->demotions);
+    }
+    set_interrupt_level(oldlevel);
+}
+
 /* Return pointer to the running thread. */
 minithread_t
 minithread_self()
@@ -310,6 +847,87 @@ minithread_id()
     return context->id;
 }
 
+/* Create a thread-specific data key */
+int
+minithread_key_create(minithread_key_t *key, void (*destructor)(void*))
+{
+    interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
+    minithread_key_t k;
+    for (k = 0; k < MINITHREAD_KEYS_MAX; ++k) {
+        if (!key_used[k]) {
+            key_used[k] = 1;
+            key_destructor[k] = destructor;
+            *key = k;
+            set_interrupt_level(oldlevel);
+            return 0;
+        }
+    }
+    set_interrupt_level(oldlevel);
+    return -1;
+}
+
+/* Delete a thread-specific data key, clearing its values so it can be reused */
+int
+minithread_key_delete(minithread_key_t key)
+{
+    interrupt_level_t oldlevel;
+    minithread_t t;
+    if (key < 0 || key >= MINITHREAD_KEYS_MAX || !key_used[key])
+        return -1;
+    oldlevel = set_interrupt_level(DISABLED);
+    for (t = all_threads; NULL != t; t = t->all_next)
+        t->specific[key] = NULL;
+    key_used[key] = 0;
+    key_destructor[key] = NULL;
+    set_interrupt_level(oldlevel);
+    return 0;
+}
+
+/* Return the value of key in the running thread */
+void*
+minithread_getspecific(minithread_key_t key)
+{
+    if (key < 0 || key >= MINITHREAD_KEYS_MAX || !key_used[key])
+        return NULL;
+    return context->specific[key];
+}
+
+/* Set the value of key in the running thread */
+int
+minithread_setspecific(minithread_key_t key, void *value)
+{
+    if (key < 0 || key >= MINITHREAD_KEYS_MAX || !key_used[key])
+        return -1;
+    context->specific[key] = value;
+    return 0;
+}
+
+/*
+ * Call the destructors of the values thread t holds. A destructor may set
+ * values again, so repeat until no value is left or for at most
+ * MINITHREAD_DESTRUCTOR_ITERATIONS rounds.
+ */
+static void
+minithread_key_destroy(minithread_t t)
+{
+    int i;
+    int k;
+    int found = 1;
+    void *value;
+    for (i = 0; found && i < MINITHREAD_DESTRUCTOR_ITERATIONS; ++i) {
+        found = 0;
+        for (k = 0; k < MINITHREAD_KEYS_MAX; ++k) {
+            if (NULL == (value = t->specific[k]))
+                continue;
+            t->specific[k] = NULL;
+            if (NULL != key_destructor[k]) {
+                key_destructor[k](value);
+                found = 1;
+            }
+        }
+    }
+}
+
 inodenum_t
 minithread_wd()
 {
@@ -353,9 +971,6 @@ minithread_system_initialize(proc_t mainproc, arg_t mainarg)
     if (minithread_initialize_scheduler() != 0) {
         exit(-1);
     }
-    if (minithread_initialize_sys_sems() != 0) {
-        exit(-1);
-    }
     if (minithread_initialize_diskio() != 0) {
         printf("Disk initialization failure.\n");
         exit(-1);
@@ -376,9 +991,8 @@ minithread_system_initialize(proc_t mainproc, arg_t mainarg)
 
     minithread_yield();
 
-    /* Idle loop */
-    while (1)
-        ;
+    /* The boot thread continues as the idle thread */
+    minithread_idle(NULL);
 }
 
 static int
@@ -387,12 +1001,21 @@ minithread_initialize_scheduler()
     int i;
     thd_count = 1;
     tid_count = 1;
-    quanta_lim[0] = 1;
+    aging_time = AGING_PERIOD;
+    quanta_lim[0] = QUANTUM;
     for (i = 1; i <= MAX_SCHED_PRIORITY; ++i)
         quanta_lim[i] = 2 * quanta_lim[i - 1];
-    ready = multilevel_queue_new(MAX_SCHED_PRIORITY + 1);
-    exited = queue_new();
-    if (NULL == ready || NULL == exited)
+
+    zombie = NULL;
+    tcb_pool = NULL;
+    tcb_pool_len = 0;
+    ready_tickets = 0;
+    for (i = 0; i <= MAX_SCHED_PRIORITY; ++i)
+        level_tickets[i] = 0;
+    stride_pass = 0;
+    stride_heap = NULL;
+    expire = -1;
+    if ((ready = multilevel_queue_new(MAX_SCHED_PRIORITY + 1)) == NULL)
         return -1;
     context = idle_thread;
     return 0;
@@ -401,60 +1024,51 @@ minithread_initialize_scheduler()
 static int
 minithread_initialize_sys_threads()
 {
-    if (NULL == minithread_fork(minithread_cleanup, NULL))
-        return -1;
     if (NULL == idle_thread)
         return -1;
     idle_thread->id = 0;
     idle_thread->status = RUNNING;
     idle_thread->priority = MAX_SCHED_PRIORITY;
-    if ((idle_thread->sleep_sem = semaphore_create()) == NULL)
-        return -1;
-    return 0;
-}
-
-static int
-minithread_initialize_sys_sems()
-{
-    exit_count = semaphore_create();
-    exit_mutex = semaphore_create();
-    id_mutex = semaphore_create();
-    if (NULL == exit_count || NULL == exit_mutex || NULL == id_mutex)
-        return -1;
-    semaphore_initialize(exit_count, 0);
-    semaphore_initialize(exit_mutex, 1);
-    semaphore_initialize(id_mutex, 1);
+    idle_thread->tickets = DEFAULT_TICKETS;
+    idle_thread->pass = 0;
+    idle_thread->stamp = ticks;
+    semaphore_initialize(&(idle_thread->sleep_sem), 0);
+    minithread_link(idle_thread);
     return 0;
 }
 
 static int
 minithread_initialize_diskio()
 {
-    /* Initialize disk. Parameters are set in the linked main program */
+    /*
+     * Initialize disk. Parameters are set in the linked main program,
+     * which sets disk_name to NULL to run without a disk.
+     */
     maindisk = &(disk_table[0]);
-    if (disk_initialize(maindisk) != 0)
+    if (disk_name != NULL && disk_initialize(maindisk) != 0)
         return -1;
 
     /* Super block */
     mainsb = &(sb_table[0]);
 
     /* Initialize cache */
-    minifile_buf_cache_init();
+    if (minifile_buf_cache_init(buffer_cache_blocks) != 0)
+        return -1;
 
-	/* Create super block lock */
-	sb_lock = semaphore_new(1);
-	if (sb_lock == NULL) {
-		return -1;
-	}
+    /* Create super block lock */
+    sb_lock = semaphore_new(1);
+    if (sb_lock == NULL) {
+        return -1;
+    }
 
     /* Initialize inode table */
-	itable_init();
+    itable_init();
 
-	/* Create inode table lock */
-	itable_lock = semaphore_new(1);
-	if (itable_lock  == NULL) {
-		return -1;
-	}
+    /* Create inode table lock */
+    itable_lock = mutex_create();
+    if (itable_lock  == NULL) {
+        return -1;
+    }
 
     return 0;
 }
@@ -464,7 +1078,6 @@ static int
 minithread_initialize_interrupts()
 {
     ticks = 0;
-    expire = -1;
 
     set_interrupt_level(DISABLED);
 
@@ -486,6 +1099,10 @@ minithread_initialize_interrupts()
 static int
 minithread_initialize_filesystem()
 {
+    /* Nothing to mount without a disk */
+    if (disk_name == NULL)
+        return 0;
+
     /* Idle thread during initialization */
     minithread_fork(minithread_fs_init_idle, NULL);
 
@@ -504,13 +1121,24 @@ minithread_initialize_filesystem()
 	minithread_set_wd(mainsb->root_inum);
 	minithread_set_wd_inode(root_inode);
 	
+    /* Write-behind of the buffer cache */
+    if (minifile_buf_cache_start() != 0) {
+        return -1;
+    }
+
+    fs_initialized = 1;
     return 0;
 }
 
+/*
+ * Keep the ready queue busy while the boot thread, which is also the idle
+ * thread, blocks on disk I/O during file system initialization. The idle
+ * thread would otherwise be picked to run while it is still blocked.
+ */
 static int
 minithread_fs_init_idle(int *arg) {
-    while (mainsb->root_inum == 0 || root_inode == NULL)
-        ;
+    while (!fs_initialized)
+        minithread_idle_wait();
     return 0;
 }
 
@@ -535,9 +1163,10 @@ void
 minithread_sleep_with_timeout(int delay)
 {
     interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
-    context->status = BLOCKED;
-    if (register_alarm(delay, &semaphore_Signal, context->sleep_sem) != -1)
-        semaphore_P(context->sleep_sem);
+    minithread_t t = context;
+    t->status = BLOCKED;
+    if (register_alarm(delay, &semaphore_Signal, &(t->sleep_sem)) != -1)
+        semaphore_P(&(t->sleep_sem));
     set_interrupt_level(oldlevel);
 }
 
@@ -550,11 +1179,12 @@ void
 clock_handler(void* arg)
 {
     interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
-    ticks++;
-    if (alarm_time > -1 && ticks >= alarm_time)
+    minithread_clock_now();
+    if (alarm_time > -1)
         alarm_signal();
-    if (ticks >= expire)
-        minithread_yield();
+    if (ticks >= aging_time)
+        minithread_age();
+    minithread_preempt();
     set_interrupt_level(oldlevel);
 }
 
@@ -573,10 +1203,14 @@ disk_handler(void* arg)
 {
     interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
     disk_interrupt_arg_t *intrpt = arg;
-    int block = intrpt->request.blocknum;
-    int blocknum = BLOCK_NUM_HASH(block);
-    bc->reply[blocknum] = intrpt->reply;
-	semaphore_V(bc->block_sig[blocknum]);
+    disk_completion_t done = intrpt->request.token;
+    if (NULL != done) {
+        done->reply = intrpt->reply;
+        if (NULL != done->func)
+            done->func(done);
+        else
+            semaphore_V_io(&(done->sig));
+    }
     free(arg);
     set_interrupt_level(oldlevel);
 }
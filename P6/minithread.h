@@ -23,6 +23,27 @@
 
 typedef struct minithread *minithread_t;
 
+/*
+ * Keys of thread-specific data, created with minithread_key_create.
+ * MINITHREAD_KEYS_MAX keys can exist at a time.
+ */
+#define MINITHREAD_KEYS_MAX 32
+
+typedef int minithread_key_t;
+
+/*
+ * Scheduling policies:
+ *	SCHED_MULTILEVEL: multilevel feedback queue, the default.
+ *	SCHED_LOTTERY: pick threads at random in proportion to their tickets.
+ *	SCHED_STRIDE: pick threads deterministically in proportion to their
+ *	tickets.
+ */
+typedef enum {
+    SCHED_MULTILEVEL,
+    SCHED_LOTTERY,
+    SCHED_STRIDE
+} sched_policy_t;
+
 /*
  * minithread_t
  * minithread_fork(proc_t proc, arg_t arg)
@@ -41,6 +62,44 @@ extern minithread_t minithread_fork(proc_t proc, arg_t arg);
  */
 extern minithread_t minithread_create(proc_t proc, arg_t arg);
 
+/*
+ * minithread_t
+ * minithread_fork_ex(proc_t proc, arg_t arg, size_t stacksize)
+ * minithread_create_ex(proc_t proc, arg_t arg, size_t stacksize)
+ *	Like minithread_fork and minithread_create, with a stack of at least
+ *	stacksize bytes. A stacksize of 0 selects the default size. Stacks
+ *	are recycled through a pool and have a guard page, so overflowing
+ *	the stack faults.
+ */
+extern minithread_t minithread_fork_ex(proc_t proc, arg_t arg, size_t stacksize);
+extern minithread_t minithread_create_ex(proc_t proc, arg_t arg, size_t stacksize);
+
+/*
+ * minithread_t minithread_fork_joinable(proc_t proc, arg_t arg)
+ *	Like minithread_fork, but the thread is joinable: it is kept after it
+ *	exits until minithread_join collects its result or minithread_detach
+ *	releases it. Threads from the other fork and create functions are
+ *	detached, and released as soon as they exit.
+ *	Return NULL when allocation fails.
+ */
+extern minithread_t minithread_fork_joinable(proc_t proc, arg_t arg);
+
+/*
+ * int minithread_join(minithread_t t, int *result)
+ *	Wait for joinable thread t to exit, then release it. If result is not
+ *	NULL, store the value returned by the proc of t in *result.
+ *	Return 0 on success, -1 if t is detached, is already being joined, or
+ *	is the caller.
+ */
+extern int minithread_join(minithread_t t, int *result);
+
+/*
+ * int minithread_detach(minithread_t t)
+ *	Make joinable thread t detached, releasing it now if it has already
+ *	exited. Return 0 on success, -1 if t is detached or is being joined.
+ */
+extern int minithread_detach(minithread_t t);
+
 /*
  * minithread_t minithread_self():
  *	Return identity (minithread_t) of caller thread.
@@ -67,6 +126,30 @@ extern void minithread_set_wd(inodenum_t inodenum);
 /* Set working directory inode */
 extern void minithread_set_wd_inode(mem_inode_t ino);
 
+/*
+ * int minithread_key_create(minithread_key_t *key, void (*destructor)(void*))
+ *	Create a key for thread-specific data, with a value of NULL in every
+ *	thread. When a thread exits with a value other than NULL for the key,
+ *	the destructor, if any, is called with that value.
+ *	Return 0 on success, -1 if no key is left.
+ *
+ * int minithread_key_delete(minithread_key_t key)
+ *	Delete key without calling its destructor. Return 0 on success, -1 if
+ *	key does not exist.
+ */
+extern int minithread_key_create(minithread_key_t *key, void (*destructor)(void*));
+extern int minithread_key_delete(minithread_key_t key);
+
+/*
+ * void *minithread_getspecific(minithread_key_t key)
+ * int minithread_setspecific(minithread_key_t key, void *value)
+ *	Get or set the value of key in the caller thread. setspecific returns
+ *	0 on success, -1 if key does not exist. getspecific returns NULL if key
+ *	does not exist.
+ */
+extern void *minithread_getspecific(minithread_key_t key);
+extern int minithread_setspecific(minithread_key_t key, void *value);
+
 /*
  * minithread_stop()
  * DEPRECATED. Beginning from project 2, you should use minithread_unlock_and_stop() instead
@@ -104,6 +187,41 @@ extern void minithread_system_initialize(proc_t mainproc, arg_t mainarg);
  */
 extern void minithread_unlock_and_stop(tas_lock_t* lock);
 
+/*
+ * minithread_set_policy(sched_policy_t policy)
+ *	Select the policy the scheduler uses to pick the next thread.
+ */
+extern void minithread_set_policy(sched_policy_t policy);
+
+/*
+ * minithread_set_tickets(minithread_t t, int tickets)
+ *	Give thread t a number of tickets (100 by default), its relative share
+ *	of the processor under the lottery and stride policies.
+ */
+extern void minithread_set_tickets(minithread_t t, int tickets);
+
+/*
+ * uint64_t minithread_idle_time()
+ *	Return the time in milliseconds the system has spent parked waiting
+ *	for an interrupt because no thread was runnable.
+ */
+extern uint64_t minithread_idle_time();
+
+/*
+ * minithread_boost(minithread_t t)
+ *	Raise thread t to the highest scheduling priority. Used when t is
+ *	woken up by the completion of an I/O operation.
+ */
+extern void minithread_boost(minithread_t t);
+
+/*
+ * minithread_stats()
+ *	Print the scheduling counters of every thread: milliseconds spent
+ *	running and waiting in a ready queue, voluntary and involuntary
+ *	switches, and priority demotions.
+ */
+extern void minithread_stats();
+
 /* This is a new function to implement in project 2.
  *
  * sleep with timeout in milliseconds
@@ -5,6 +5,7 @@
 #ifndef __MINITHREAD_STRUCT_H__
 #define __MINITHREAD_STRUCT_H__
 
+#include "interrupts.h"
 #include "minifile_fs.h"
 #include "minithread.h"
 #include "queue_private.h"
@@ -14,6 +15,24 @@
 /* Maximium priority level. Minimum is 0. */
 #define MAX_SCHED_PRIORITY 3
 
+/* Tickets of a new thread, for the lottery and stride policies */
+#define DEFAULT_TICKETS 100
+
+/* Stride of a thread holding a single ticket */
+#define STRIDE1 (1 << 20)
+
+/* Length in ticks of the quanta at the highest priority */
+#define QUANTUM (PERIOD / MILLISECOND)
+
+/* Ticks between raising every ready thread one priority level */
+#define AGING_PERIOD (20 * QUANTUM)
+
+/* Rounds of destructor calls for values set again by a destructor */
+#define MINITHREAD_DESTRUCTOR_ITERATIONS 4
+
+/* Maximum number of released control blocks kept for reuse */
+#define TCB_POOL_MAX 64
+
 /*
  * Define constants for thread status.
  */
@@ -31,18 +50,57 @@ enum status {
  * id: thread id.
  * top: stack pointer, points to the top of the stack.
  * base: points to the base of the stack.
+ * stacksize: requested size of the stack.
  * status: thread current status, RUNNING, BLOCKED OR EXITED.
  * priority: determines the scheduling queue and the quanta of the thread.
  * sleep_sem: thread sleeps on this semaphore.
+ * tickets: share of the processor under the lottery and stride policies.
+ * pass: virtual time of the thread under the stride policy.
+ * stride_left, stride_right, stride_rank: links and rank of the thread in
+ *   the leftist heap of ready threads ordered by pass, under stride.
+ * all_prev, all_next: links in the list of all threads.
+ * stamp: time the thread last started running or became ready.
+ * run_ticks: ticks spent running.
+ * wait_ticks: ticks spent ready but not running.
+ * voluntary: switches out because the thread yielded, blocked or exited.
+ * involuntary: switches out because the thread was preempted.
+ * demotions: times the thread dropped a priority level.
+ * specific: values of the thread-specific data keys.
+ * proc, arg: procedure the thread runs and its argument.
+ * result: value returned by proc.
+ * joinable: the thread is kept after it exits until it is joined.
+ * joined: a thread is waiting in minithread_join for this thread.
+ * join_sem: signaled when a joinable thread exits.
  */
 struct minithread {
     struct node qnode;
     unsigned int id;
     stack_pointer_t top;
     stack_pointer_t base;
+    size_t stacksize;
     enum status status;
     int priority;
-    semaphore_t sleep_sem;
+    struct semaphore sleep_sem;
+    int tickets;
+    long pass;
+    minithread_t stride_left;
+    minithread_t stride_right;
+    int stride_rank;
+    minithread_t all_prev;
+    minithread_t all_next;
+    long stamp;
+    long run_ticks;
+    long wait_ticks;
+    unsigned int voluntary;
+    unsigned int involuntary;
+    unsigned int demotions;
+    void *specific[MINITHREAD_KEYS_MAX];
+    proc_t proc;
+    arg_t arg;
+    int result;
+    int joinable;
+    int joined;
+    struct semaphore join_sem;
     inodenum_t current_dir;
 	mem_inode_t current_dir_inode;
 };
@@ -1,7 +1,86 @@
+/*
+ * Alarm tester.
+ *
+ * First a benchmark registers BENCH_ALARMS alarms, cancels them in random
+ * order and times both, then checks that a burst of short alarms all
+ * fire, and that cancelling an alarm long gone does not cancel a later
+ * alarm reusing its slot. Then threads sleep for various times and report when they wake.
+ */
+
 #include "minithread.h"
+#include "alarm.h"
+#include "disk.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 extern long ticks;
 
+#define BENCH_ALARMS 100000
+#define BURST_ALARMS 1000
+#define STALE_ALARMS 2048   /* Registrations wrapping an 11-bit generation */
+
+static int fired = 0;
+
+static long
+now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void
+count_alarm(void *arg)
+{
+    fired++;
+}
+
+static void
+bench(void)
+{
+    long *id = malloc(BENCH_ALARMS * sizeof(long));
+    long t;
+    long stale;
+    int i, j;
+    long start;
+
+    start = now_ns();
+    for (i = 0; i < BENCH_ALARMS; i++)
+        id[i] = register_alarm(1000 + rand() % 100000, count_alarm, NULL);
+    printf("Registered %d alarms, %ld ns each.\n", BENCH_ALARMS,
+           (now_ns() - start) / BENCH_ALARMS);
+
+    for (i = BENCH_ALARMS - 1; i > 0; i--) {
+        j = rand() % (i + 1);
+        t = id[i];
+        id[i] = id[j];
+        id[j] = t;
+    }
+    start = now_ns();
+    for (i = 0; i < BENCH_ALARMS; i++)
+        deregister_alarm(id[i]);
+    printf("Deregistered %d alarms, %ld ns each.\n", BENCH_ALARMS,
+           (now_ns() - start) / BENCH_ALARMS);
+    free(id);
+
+    for (i = 0; i < BURST_ALARMS; i++)
+        register_alarm(i % 50, count_alarm, NULL);
+    minithread_sleep_with_timeout(100);
+    printf("%d of %d burst alarms fired.\n", fired, BURST_ALARMS);
+
+    /* The pool reuses the slot just freed, so all of these share one */
+    stale = register_alarm(10, count_alarm, NULL);
+    deregister_alarm(stale);
+    for (i = 1; i < STALE_ALARMS; i++)
+        deregister_alarm(register_alarm(10, count_alarm, NULL));
+    fired = 0;
+    register_alarm(10, count_alarm, NULL);
+    deregister_alarm(stale);
+    minithread_sleep_with_timeout(100);
+    printf("Alarm %s after cancelling an id %d registrations old.\n",
+           fired ? "fired" : "did not fire", STALE_ALARMS);
+}
+
 int
 thread0(int *arg)
 {
@@ -53,6 +132,7 @@ int thread3(int *arg)
 
 int run(int *arg)
 {
+    bench();
     minithread_fork(thread0, NULL);
     minithread_fork(thread1, NULL);
     minithread_fork(thread2, NULL);
@@ -62,6 +142,7 @@ int run(int *arg)
 
 int main()
 {
+    disk_name = NULL;
     minithread_system_initialize(run, NULL);
     return 0;
 }
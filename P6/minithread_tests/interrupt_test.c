@@ -0,0 +1,110 @@
+/*
+ * Deferred interrupt tester.
+ *
+ * A disk read completes while interrupts are disabled. Its interrupt is
+ * deferred, and its handler runs as soon as interrupts are enabled
+ * again, before set_interrupt_level returns. Pass any argument to drop
+ * interrupts instead, where the disk resends it until it is taken. The
+ * interrupt statistics should show the disk latency and the section with
+ * interrupts disabled at about 200 ms. A disk interrupt deferred when a
+ * new thread is switched to is run before the thread starts. The test
+ * reads from a scratch disk of its own and does not need minidisk.
+ */
+
+#include "minithread.h"
+#include "interrupts.h"
+#include "synch.h"
+#include "disk.h"
+#include "minifile_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DISABLED_MS 200
+#define DISK_BLOCKS 16
+
+static volatile int handled = 0;
+static int handled_at_start = 0;
+static semaphore_t started;
+
+static long
+now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void
+test_disk_handler(void *arg)
+{
+    ++handled;
+    free(arg);
+}
+
+static int
+starter(int *arg)
+{
+    handled_at_start = handled;
+    semaphore_V(started);
+    return 0;
+}
+
+int
+run(int *arg)
+{
+    char buf[DISK_BLOCK_SIZE];
+    interrupt_level_t oldlevel;
+    long start;
+    int before;
+    int after;
+
+    install_disk_handler(test_disk_handler);
+    interrupt_stats_reset();
+    oldlevel = set_interrupt_level(DISABLED);
+    disk_read_block(maindisk, 0, buf);
+    start = now_ms();
+    while (now_ms() - start < DISABLED_MS)
+        ;
+    before = handled;
+    set_interrupt_level(oldlevel);
+    after = handled;
+
+    start = now_ms();
+    while (!handled && now_ms() - start < 10 * DISABLED_MS)
+        minithread_yield();
+    printf("Handled %d while disabled, %d on enabling, %d after %ld ms.\n",
+           before, after, handled, now_ms() - start);
+    interrupt_stats();
+
+    if (INTERRUPT_DEFER == interrupt_mode) {
+        started = semaphore_create();
+        semaphore_initialize(started, 0);
+        before = handled;
+        oldlevel = set_interrupt_level(DISABLED);
+        disk_read_block(maindisk, 0, buf);
+        start = now_ms();
+        while (now_ms() - start < DISABLED_MS / 4)
+            ;
+        minithread_fork(starter, NULL);
+        semaphore_P(started);
+        set_interrupt_level(oldlevel);
+        printf("Handled %d of 1 before a new thread started.\n",
+               handled_at_start - before);
+    }
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    interrupt_mode = (argc > 1) ? INTERRUPT_DROP : INTERRUPT_DEFER;
+    interrupt_time_disabled = 1;
+    use_existing_disk = 0;
+    disk_name = "interrupt_test.disk";
+    disk_flags = DISK_READWRITE;
+    disk_size = DISK_BLOCKS;
+    minithread_system_initialize(run, NULL);
+    return 0;
+}
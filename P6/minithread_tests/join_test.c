@@ -0,0 +1,81 @@
+/*
+ * Join tester.
+ *
+ * Fan out a sum over joinable workers and join them for their partial
+ * sums, then check that detached threads are released.
+ */
+
+#include "minithread.h"
+#include "synch.h"
+#include "disk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_WORKERS 8
+#define NUM_VALUES 8000
+
+int values[NUM_VALUES];
+
+int
+partial_sum(int *arg)
+{
+    int i;
+    int sum = 0;
+    for (i = *arg; i < *arg + NUM_VALUES / NUM_WORKERS; ++i) {
+        sum += values[i];
+        if (i % 100 == 0)
+            minithread_yield();
+    }
+    return sum;
+}
+
+int
+nothing(int *arg)
+{
+    return 0;
+}
+
+int
+fanout(int *arg)
+{
+    minithread_t workers[NUM_WORKERS];
+    int start[NUM_WORKERS];
+    int i;
+    int part;
+    int sum = 0;
+    minithread_t t;
+
+    for (i = 0; i < NUM_VALUES; ++i)
+        values[i] = i;
+    for (i = 0; i < NUM_WORKERS; ++i) {
+        start[i] = i * (NUM_VALUES / NUM_WORKERS);
+        workers[i] = minithread_fork_joinable(partial_sum, &start[i]);
+    }
+    for (i = 0; i < NUM_WORKERS; ++i) {
+        if (minithread_join(workers[i], &part) != 0)
+            printf("Join %d failed.\n", i);
+        sum += part;
+    }
+    printf("Sum %d, expected %d.\n", sum, NUM_VALUES * (NUM_VALUES - 1) / 2);
+
+    /* Detach before and after exit */
+    t = minithread_fork_joinable(nothing, NULL);
+    minithread_detach(t);
+    t = minithread_fork_joinable(nothing, NULL);
+    minithread_yield();
+    minithread_detach(t);
+    if (minithread_join(minithread_fork(nothing, NULL), NULL) != -1)
+        printf("Joined a detached thread.\n");
+    minithread_yield();
+    minithread_stats();
+    return 0;
+}
+
+int
+main(void)
+{
+    disk_name = NULL;
+    minithread_system_initialize(fanout, NULL);
+    return 0;
+}
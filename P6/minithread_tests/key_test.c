@@ -0,0 +1,74 @@
+/*
+ * Thread-specific data tester.
+ *
+ * Threads keep a private counter under a key and check that it is not
+ * disturbed by the other threads. The destructor frees the counters when
+ * the threads exit.
+ */
+
+#include "minithread.h"
+#include "synch.h"
+#include "disk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_THREADS 8
+#define NUM_ROUNDS 100
+
+minithread_key_t counter_key;
+semaphore_t done;
+int freed = 0;
+int errors = 0;
+
+void
+counter_free(void *value)
+{
+    free(value);
+    ++freed;
+}
+
+int
+worker(int *arg)
+{
+    int i;
+    int *counter = malloc(sizeof(int));
+    *counter = 0;
+    minithread_setspecific(counter_key, counter);
+    for (i = 0; i < NUM_ROUNDS; ++i) {
+        counter = minithread_getspecific(counter_key);
+        if (*counter != i)
+            ++errors;
+        ++*counter;
+        minithread_yield();
+    }
+    semaphore_V(done);
+    return 0;
+}
+
+int
+spawn(int *arg)
+{
+    int i;
+    done = semaphore_new(0);
+    if (minithread_key_create(&counter_key, counter_free) != 0) {
+        printf("Failed to create key.\n");
+        return -1;
+    }
+    for (i = 0; i < NUM_THREADS; ++i)
+        minithread_fork(worker, NULL);
+    for (i = 0; i < NUM_THREADS; ++i)
+        semaphore_P(done);
+    /* Let the workers exit */
+    minithread_yield();
+    printf("%d errors, %d of %d values freed.\n", errors, freed, NUM_THREADS);
+    return 0;
+}
+
+int
+main(void)
+{
+    disk_name = NULL;
+    minithread_system_initialize(spawn, NULL);
+    return 0;
+}
@@ -1,37 +1,37 @@
-#include <stdio.h>
-#include <stdlib.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include "multilevel_queue_private.h"
 
 #define LEVEL 4
-
-typedef struct item {
-    struct item* prev;
-    struct item* next;
-    queue_t queue;
-    int data;
-} item;
+
+typedef struct item {
+    struct item* prev;
+    struct item* next;
+    queue_t queue;
+    int data;
+} item;
 
 int
-print_item(void* item1, void* item2) {
-    printf("%d ",((item*)item2)->data);
-    return 0;
+print_item(void* item1, void* item2) {
+    printf("%d ",((item*)item2)->data);
+    return 0;
 }
-
-int
-main() {
-    int i,j;
-    item num[100];
-    item *it;
-    multilevel_queue_t mq = multilevel_queue_new(LEVEL);
-
+
+int
+main() {
+    int i,j;
+    item num[100];
+    item *it;
+    multilevel_queue_t mq = multilevel_queue_new(LEVEL);
+
     for (j=0; j<LEVEL; ++j) {
         printf("Level %d:\n",j);
 
-        printf("Append 0 to 29:\n");
-        for (i = 0; i < 30; ++i) {
-            num[i].data = i;
-            if (-1 == multilevel_queue_enqueue(mq, i % LEVEL, num+i))
-                printf("multilevel_queue_enqueue failed on i = %d\n",i);
+        printf("Append 0 to 29:\n");
+        for (i = 0; i < 30; ++i) {
+            num[i].data = i;
+            if (-1 == multilevel_queue_enqueue(mq, i % LEVEL, num+i))
+                printf("multilevel_queue_enqueue failed on i = %d\n",i);
         }
 
         printf("Inspect each queue:\n");
@@ -40,14 +40,14 @@ main() {
             printf("\n");
         }
 
-        printf("Dequeue 0 to 29 from level %d:\n",j);
-        for (i = 0; i < 30; ++i) {
-            if (-1 == multilevel_queue_dequeue(mq, j, (void**) &it))
+        printf("Dequeue 0 to 29 from level %d:\n",j);
+        for (i = 0; i < 30; ++i) {
+            if (-1 == multilevel_queue_dequeue(mq, j, (void**) &it))
                 printf("multilevel_queue_dequeue failed on i = %d\n",i);
             if (NULL == it)
                 printf("Dequeue fails on %d\n", i);
             else
-                printf("%d ", it->data);
+                printf("%d ", it->data);
         }
         printf("\n");
 
@@ -56,12 +56,27 @@ main() {
             queue_iterate(mq->q[i], print_item, NULL);
             printf("\n");
         }
-    }
+    }
+
+    printf("Raise level 3 to level 1 over 0 to 29, then delete 9:\n");
+    for (i = 0; i < 30; ++i)
+        multilevel_queue_enqueue(mq, i % LEVEL, num+i);
+    for (j = 1; j < LEVEL; ++j)
+        printf("Raised %d from level %d\n", multilevel_queue_raise(mq, j), j);
+    if (multilevel_queue_level(mq, num+9) != 0 ||
+            multilevel_queue_delete(mq, num+9) != 0)
+        printf("multilevel_queue_delete failed on 9\n");
+    for (i = 0; i < LEVEL; ++i) {
+        queue_iterate(mq->q[i], print_item, NULL);
+        printf("\n");
+    }
+    while (multilevel_queue_dequeue(mq, 0, (void**) &it) != -1)
+        ;
 
     if (-1 == multilevel_queue_free(mq))
         printf("multilevel_queue_free failed.\n");
     else
         printf("multilevel_queue_free succeeded.\n");
-
-    return 0;
-}
+
+    return 0;
+}
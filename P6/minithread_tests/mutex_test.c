@@ -0,0 +1,139 @@
+/*
+ * Mutex and condition variable tester.
+ *
+ * Threads increment a shared counter under a mutex, yielding inside the
+ * critical section so the others contend for it. Then a bounded buffer
+ * is filled by producers and drained by consumers through condition
+ * variables, and a broadcast releases threads waiting on a gate.
+ */
+
+#include "minithread.h"
+#include "synch.h"
+#include "disk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_THREADS 8
+#define NUM_ROUNDS 1000
+#define BUFFER_SIZE 4
+
+mutex_t lock;
+cond_t not_full;
+cond_t not_empty;
+cond_t gate;
+semaphore_t done;
+
+int counter = 0;
+int items = 0;
+int consumed = 0;
+int open = 0;
+int passed = 0;
+
+int
+incrementer(int *arg)
+{
+    int i;
+    int v;
+    for (i = 0; i < NUM_ROUNDS; ++i) {
+        mutex_lock(lock);
+        v = counter;
+        if (i % 7 == 0)
+            minithread_yield();
+        counter = v + 1;
+        mutex_unlock(lock);
+    }
+    semaphore_V(done);
+    return 0;
+}
+
+int
+producer(int *arg)
+{
+    int i;
+    for (i = 0; i < NUM_ROUNDS; ++i) {
+        mutex_lock(lock);
+        while (items == BUFFER_SIZE)
+            cond_wait(not_full, lock);
+        ++items;
+        cond_signal(not_empty);
+        mutex_unlock(lock);
+    }
+    semaphore_V(done);
+    return 0;
+}
+
+int
+consumer(int *arg)
+{
+    int i;
+    for (i = 0; i < NUM_ROUNDS; ++i) {
+        mutex_lock(lock);
+        while (items == 0)
+            cond_wait(not_empty, lock);
+        --items;
+        ++consumed;
+        cond_signal(not_full);
+        mutex_unlock(lock);
+    }
+    semaphore_V(done);
+    return 0;
+}
+
+int
+waiter(int *arg)
+{
+    mutex_lock(lock);
+    while (!open)
+        cond_wait(gate, lock);
+    ++passed;
+    mutex_unlock(lock);
+    semaphore_V(done);
+    return 0;
+}
+
+int
+run(int *arg)
+{
+    int i;
+    lock = mutex_create();
+    not_full = cond_create();
+    not_empty = cond_create();
+    gate = cond_create();
+    done = semaphore_new(0);
+
+    for (i = 0; i < NUM_THREADS; ++i)
+        minithread_fork(incrementer, NULL);
+    for (i = 0; i < NUM_THREADS; ++i)
+        semaphore_P(done);
+    printf("Counter %d, expected %d.\n", counter, NUM_THREADS * NUM_ROUNDS);
+
+    for (i = 0; i < NUM_THREADS / 2; ++i) {
+        minithread_fork(producer, NULL);
+        minithread_fork(consumer, NULL);
+    }
+    for (i = 0; i < NUM_THREADS; ++i)
+        semaphore_P(done);
+    printf("Consumed %d, expected %d.\n", consumed,
+           NUM_THREADS / 2 * NUM_ROUNDS);
+
+    for (i = 0; i < NUM_THREADS; ++i)
+        minithread_fork(waiter, NULL);
+    minithread_yield();
+    mutex_lock(lock);
+    open = 1;
+    cond_broadcast(gate);
+    mutex_unlock(lock);
+    for (i = 0; i < NUM_THREADS; ++i)
+        semaphore_P(done);
+    printf("%d of %d waiters passed the gate.\n", passed, NUM_THREADS);
+    return 0;
+}
+
+int
+main(void)
+{
+    disk_name = NULL;
+    minithread_system_initialize(run, NULL);
+    return 0;
+}
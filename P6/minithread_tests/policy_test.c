@@ -0,0 +1,87 @@
+/*
+ * Scheduling policy tester.
+ *
+ * Three yielding threads holding 100, 200 and 300 tickets count how often
+ * they get to run. Under the lottery and stride policies the counts should
+ * come out within TOLERANCE percent of 1:2:3, or the test exits with 1.
+ */
+
+#include "minithread.h"
+#include "synch.h"
+#include "disk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_THREADS 3
+#define TOTAL_RUNS 6000
+#define TOLERANCE 15
+
+semaphore_t done;
+int count[NUM_THREADS];
+int total;
+
+int
+counter(int *arg)
+{
+    while (total < TOTAL_RUNS) {
+        ++count[*arg];
+        ++total;
+        minithread_yield();
+    }
+    semaphore_V(done);
+    return 0;
+}
+
+void
+run(sched_policy_t policy, char *name, int check)
+{
+    int i;
+    int expected;
+    int off = 0;
+    int id[NUM_THREADS];
+    minithread_t t[NUM_THREADS];
+
+    total = 0;
+    minithread_set_policy(policy);
+    for (i = 0; i < NUM_THREADS; ++i) {
+        id[i] = i;
+        count[i] = 0;
+        t[i] = minithread_create(counter, &id[i]);
+        minithread_set_tickets(t[i], 100 * (i + 1));
+    }
+    for (i = 0; i < NUM_THREADS; ++i)
+        minithread_start(t[i]);
+    for (i = 0; i < NUM_THREADS; ++i)
+        semaphore_P(done);
+    printf("%s:", name);
+    for (i = 0; i < NUM_THREADS; ++i) {
+        printf(" %d", count[i]);
+        expected = TOTAL_RUNS * (i + 1) / (NUM_THREADS * (NUM_THREADS + 1) / 2);
+        if (abs(count[i] - expected) * 100 > expected * TOLERANCE)
+            off = 1;
+    }
+    printf("\n");
+    if (check && off) {
+        printf("%s: counts are off 1:2:3 by more than %d%%\n", name, TOLERANCE);
+        exit(1);
+    }
+}
+
+int
+test(int *arg)
+{
+    done = semaphore_new(0);
+    run(SCHED_MULTILEVEL, "multilevel", 0);
+    run(SCHED_LOTTERY, "lottery", 1);
+    run(SCHED_STRIDE, "stride", 1);
+    return 0;
+}
+
+int
+main(void)
+{
+    disk_name = NULL;
+    minithread_system_initialize(test, NULL);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Reader-writer lock tester.
+ *
+ * Readers and writers share a pair of counters that writers keep equal,
+ * yielding inside their critical sections. Readers must never see the
+ * pair torn and should overlap with each other, writers must run alone.
+ * Then a writer queues behind a reader, and a reader arriving after it
+ * must wait for the writer.
+ */
+
+#include "minithread.h"
+#include "synch.h"
+#include "disk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_READERS 6
+#define NUM_WRITERS 2
+#define NUM_ROUNDS 500
+
+rwlock_t lock;
+semaphore_t done;
+
+int a = 0;
+int b = 0;
+int reading = 0;
+int most_reading = 0;
+int writing = 0;
+int torn = 0;
+int overlapped = 0;
+int order[2];
+int ordered = 0;
+
+int
+reader(int *arg)
+{
+    int i;
+    for (i = 0; i < NUM_ROUNDS; ++i) {
+        rwlock_rdlock(lock);
+        if (writing)
+            ++overlapped;
+        if (++reading > most_reading)
+            most_reading = reading;
+        if (a != b)
+            ++torn;
+        minithread_yield();
+        if (a != b)
+            ++torn;
+        --reading;
+        rwlock_unlock(lock);
+    }
+    semaphore_V(done);
+    return 0;
+}
+
+int
+writer(int *arg)
+{
+    int i;
+    for (i = 0; i < NUM_ROUNDS; ++i) {
+        rwlock_wrlock(lock);
+        if (reading || writing)
+            ++overlapped;
+        writing = 1;
+        ++a;
+        minithread_yield();
+        ++b;
+        writing = 0;
+        rwlock_unlock(lock);
+        minithread_yield();
+    }
+    semaphore_V(done);
+    return 0;
+}
+
+int
+late_writer(int *arg)
+{
+    rwlock_wrlock(lock);
+    order[ordered++] = 'w';
+    rwlock_unlock(lock);
+    semaphore_V(done);
+    return 0;
+}
+
+int
+late_reader(int *arg)
+{
+    rwlock_rdlock(lock);
+    order[ordered++] = 'r';
+    rwlock_unlock(lock);
+    semaphore_V(done);
+    return 0;
+}
+
+int
+run(int *arg)
+{
+    int i;
+    lock = rwlock_create();
+    done = semaphore_new(0);
+
+    for (i = 0; i < NUM_READERS; ++i)
+        minithread_fork(reader, NULL);
+    for (i = 0; i < NUM_WRITERS; ++i)
+        minithread_fork(writer, NULL);
+    for (i = 0; i < NUM_READERS + NUM_WRITERS; ++i)
+        semaphore_P(done);
+    printf("Counters %d and %d, expected %d.\n", a, b,
+           NUM_WRITERS * NUM_ROUNDS);
+    printf("%d torn reads, %d overlapping writers.\n", torn, overlapped);
+    printf("Up to %d readers at a time.\n", most_reading);
+
+    /* Hold the lock shared while a writer, then a reader, queue up */
+    rwlock_rdlock(lock);
+    minithread_fork(late_writer, NULL);
+    minithread_yield();
+    minithread_fork(late_reader, NULL);
+    minithread_yield();
+    rwlock_unlock(lock);
+    semaphore_P(done);
+    semaphore_P(done);
+    printf("Waiting writer went %s the late reader.\n",
+           ('w' == order[0]) ? "before" : "after");
+    return 0;
+}
+
+int
+main(void)
+{
+    disk_name = NULL;
+    minithread_system_initialize(run, NULL);
+    return 0;
+}
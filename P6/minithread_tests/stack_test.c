@@ -0,0 +1,61 @@
+/*
+ * Stack pool tester.
+ *
+ * Fork rounds of short lived threads with small and default sized stacks
+ * and report how many stacks were reused from the pool.
+ */
+
+#include "minithread.h"
+#include "machineprimitives.h"
+#include "synch.h"
+#include "disk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_THREADS 32
+#define NUM_ROUNDS 20
+
+semaphore_t done;
+
+int
+child(int *arg)
+{
+    volatile char buf[1024];
+    buf[0] = (char) *arg;
+    semaphore_V(done);
+    return buf[0];
+}
+
+int
+spawn(int *arg)
+{
+    int i, j;
+    long hits, misses;
+
+    done = semaphore_new(0);
+    for (i = 0; i < NUM_ROUNDS; ++i) {
+        for (j = 0; j < NUM_THREADS; ++j) {
+            if (j % 2 == 0)
+                minithread_fork_ex(child, &j, 16 * 1024);
+            else
+                minithread_fork(child, &j);
+        }
+        for (j = 0; j < NUM_THREADS; ++j)
+            semaphore_P(done);
+        /* Let the finished threads be reclaimed */
+        minithread_sleep_with_timeout(100);
+    }
+    minithread_stack_pool_stats(&hits, &misses);
+    printf("Forked %d threads: %ld stacks reused, %ld allocated.\n",
+           NUM_THREADS * NUM_ROUNDS, hits, misses);
+    return 0;
+}
+
+int
+main(void)
+{
+    disk_name = NULL;
+    minithread_system_initialize(spawn, NULL);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Context switch benchmark.
+ *
+ * Measure the cost of a switch between two threads, first when they yield
+ * to each other and then when they hand off through a pair of semaphores.
+ */
+
+#include "minithread.h"
+#include "synch.h"
+#include "disk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NUM_SWITCHES 1000000
+
+semaphore_t ping;
+semaphore_t pong;
+semaphore_t done;
+
+static double
+now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int
+yielder(int *arg)
+{
+    int i;
+    for (i = 0; i < NUM_SWITCHES / 2; ++i)
+        minithread_yield();
+    semaphore_V(done);
+    return 0;
+}
+
+int
+ponger(int *arg)
+{
+    int i;
+    for (i = 0; i < NUM_SWITCHES / 2; ++i) {
+        semaphore_P(ping);
+        semaphore_V(pong);
+    }
+    return 0;
+}
+
+int
+bench(int *arg)
+{
+    int i;
+    double start;
+
+    ping = semaphore_new(0);
+    pong = semaphore_new(0);
+    done = semaphore_new(0);
+
+    start = now_ns();
+    minithread_fork(yielder, NULL);
+    minithread_fork(yielder, NULL);
+    semaphore_P(done);
+    semaphore_P(done);
+    printf("yield: %.1f ns per switch\n", (now_ns() - start) / NUM_SWITCHES);
+
+    start = now_ns();
+    minithread_fork(ponger, NULL);
+    for (i = 0; i < NUM_SWITCHES / 2; ++i) {
+        semaphore_V(ping);
+        semaphore_P(pong);
+    }
+    printf("semaphore: %.1f ns per switch\n",
+           (now_ns() - start) / NUM_SWITCHES);
+    return 0;
+}
+
+int
+main(void)
+{
+    disk_name = NULL;
+    minithread_system_initialize(bench, NULL);
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * Wall clock alarm tester.
+ *
+ * One thread sleeps for a second while another keeps the host blocked in
+ * system calls. The host uses no processor time, so with the wall clock
+ * time source the sleeper still wakes up on time. Pass any argument to
+ * run on ticks instead, where the sleep stretches out. The test program
+ * is not linked between start and end, so it is never preempted; the
+ * blocker sleeps briefly between the calls to let due alarms fire.
+ */
+
+#include "minithread.h"
+#include "alarm.h"
+#include "synch.h"
+#include "disk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SLEEP_MS 1000
+#define BLOCK_MS 100
+
+static volatile int woken = 0;
+
+static long
+now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int
+sleeper(int *arg)
+{
+    long start = now_ms();
+    minithread_sleep_with_timeout(SLEEP_MS);
+    printf("Slept %d ms, woke after %ld ms.\n", SLEEP_MS, now_ms() - start);
+    woken = 1;
+    return 0;
+}
+
+int
+blocker(int *arg)
+{
+    int i;
+    minithread_fork(sleeper, NULL);
+    minithread_yield();
+    /* Give up after ten times the sleep */
+    for (i = 0; !woken && i < 10 * SLEEP_MS / BLOCK_MS; ++i) {
+        usleep(BLOCK_MS * 1000);
+        minithread_sleep_with_timeout(1);
+    }
+    if (!woken)
+        printf("Sleeper did not wake up within %d ms.\n", 10 * SLEEP_MS);
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    alarm_source = (argc > 1) ? ALARM_SOURCE_TICKS : ALARM_SOURCE_WALL;
+    disk_name = NULL;
+    minithread_system_initialize(blocker, NULL);
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "queue.h"
+#include "queue_private.h"
 #include "multilevel_queue.h"
 #include "multilevel_queue_private.h"
 
@@ -15,11 +16,15 @@ multilevel_queue_t
 multilevel_queue_new(int number_of_levels)
 {
     int i;
-    multilevel_queue_t mq = malloc(sizeof(struct multilevel_queue));
-    if (NULL == mq)
+    multilevel_queue_t mq;
+    if (number_of_levels <= 0 || number_of_levels > MULTILEVEL_QUEUE_MAX_LEVELS)
+        return NULL;
+    if ((mq = malloc(sizeof(struct multilevel_queue))) == NULL)
         return NULL;
     mq->lvl = number_of_levels;
-    mq->q = malloc(mq->lvl * sizeof(struct multilevel_queue));
+    mq->len = 0;
+    mq->map = 0;
+    mq->q = malloc(mq->lvl * sizeof(queue_t));
     if (NULL == mq->q) {
         multilevel_queue_free(mq);
         return NULL;
@@ -45,7 +50,11 @@ multilevel_queue_enqueue(multilevel_queue_t queue, int level, void* item)
 {
     if (NULL == queue || level < 0 || level >= queue->lvl)
         return -1;
-    return queue_append(queue->q[level], item);
+    if (queue_append(queue->q[level], item) == -1)
+        return -1;
+    queue->map |= 1u << level;
+    ++(queue->len);
+    return 0;
 }
 
 /*
@@ -57,19 +66,131 @@ multilevel_queue_enqueue(multilevel_queue_t queue, int level, void* item)
 int
 multilevel_queue_dequeue(multilevel_queue_t queue, int level, void** item)
 {
-    int i;
+    unsigned int mask;
     int curr;
     if (NULL == queue || level < 0 || level >= queue->lvl || NULL == item)
         return -1;
+    /* First non-empty level at or above level, else the lowest one */
+    mask = queue->map & (~0u << level);
+    if (0 == mask)
+        mask = queue->map;
+    if (0 == mask) {
+        *item = NULL;
+        return -1;
+    }
+    curr = __builtin_ctz(mask);
+    if (queue_dequeue(queue->q[curr], item) == -1)
+        return -1;
+    if (queue_length(queue->q[curr]) == 0)
+        queue->map &= ~(1u << curr);
+    --(queue->len);
+    return curr;
+}
+
+/*
+ * Delete the specified item from whichever level it is on.
+ * Return the level the item was deleted from, or -1 (failure).
+ */
+int
+multilevel_queue_delete(multilevel_queue_t queue, void* item)
+{
+    int i;
+    if (NULL == queue || NULL == item)
+        return -1;
     for (i = 0; i < queue->lvl; ++i) {
-        curr = (level + i) % queue->lvl;
-        if (0 == queue_dequeue(queue->q[curr], item))
-            return curr;
+        if (((node_t) item)->queue != queue->q[i])
+            continue;
+        if (queue_delete(queue->q[i], &item) == -1)
+            return -1;
+        if (queue_length(queue->q[i]) == 0)
+            queue->map &= ~(1u << i);
+        --(queue->len);
+        return i;
     }
-    *item = NULL;
     return -1;
 }
 
+/*
+ * Iterate f over the items of every level, from level 0 up.
+ * Stop early and return -1 if f returns -1, return 0 otherwise.
+ */
+int
+multilevel_queue_iterate(multilevel_queue_t queue, PFany f, void* arg)
+{
+    int i;
+    if (NULL == queue || NULL == f)
+        return -1;
+    for (i = 0; i < queue->lvl; ++i) {
+        if (queue_iterate(queue->q[i], f, arg) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+/*
+ * Iterate f over the items of the specified level.
+ * Stop early and return -1 if f returns -1, return 0 otherwise.
+ */
+int
+multilevel_queue_iterate_level(multilevel_queue_t queue, int level, PFany f, void* arg)
+{
+    if (NULL == queue || level < 0 || level >= queue->lvl || NULL == f)
+        return -1;
+    return queue_iterate(queue->q[level], f, arg);
+}
+
+/*
+ * Return the level the specified item is on, or -1 if it is not on the queue.
+ */
+int
+multilevel_queue_level(multilevel_queue_t queue, void* item)
+{
+    int i;
+    if (NULL == queue || NULL == item)
+        return -1;
+    for (i = 0; i < queue->lvl; ++i) {
+        if (((node_t) item)->queue == queue->q[i])
+            return i;
+    }
+    return -1;
+}
+
+/*
+ * Move every item on the specified level to the tail of the level below it.
+ * The items are relinked from the shorter level to the longer one, and the
+ * two queues swap places if the items end up in the upper one.
+ * Return the number of items moved, or -1 (failure).
+ */
+int
+multilevel_queue_raise(multilevel_queue_t queue, int level)
+{
+    queue_t joined;
+    int n;
+    if (NULL == queue || level <= 0 || level >= queue->lvl)
+        return -1;
+    n = queue_length(queue->q[level]);
+    joined = queue_join(queue->q[level - 1], queue->q[level]);
+    if (joined == queue->q[level]) {
+        queue->q[level] = queue->q[level - 1];
+        queue->q[level - 1] = joined;
+    }
+    queue->map &= ~(1u << level);
+    if (n > 0)
+        queue->map |= 1u << (level - 1);
+    return n;
+}
+
+/*
+ * Return the total number of items on all levels, or -1 if queue is NULL.
+ */
+int
+multilevel_queue_length(multilevel_queue_t queue)
+{
+    if (NULL == queue)
+        return -1;
+    return queue->len;
+}
+
 /*
  * Free the queue and return 0 (success) or -1 (failure). Do not free the queue nodes; this is
  * the responsibility of the programmer.
@@ -80,8 +201,11 @@ multilevel_queue_free(multilevel_queue_t queue)
     int i;
     if (NULL == queue)
         return -1;
-    for (i = 0; i < queue->lvl; ++i)
-        queue_free(queue->q[i]);
+    if (NULL != queue->q) {
+        for (i = 0; i < queue->lvl; ++i)
+            queue_free(queue->q[i]);
+        free(queue->q);
+    }
     free(queue);
     return 0;
 }
@@ -15,6 +15,7 @@ typedef struct multilevel_queue* multilevel_queue_t;
 
 /*
  * Returns an empty multilevel queue with number_of_levels levels. On error should return NULL.
+ * At most 32 levels are supported.
  */
 extern multilevel_queue_t multilevel_queue_new(int number_of_levels);
 
@@ -31,6 +32,42 @@ extern int multilevel_queue_enqueue(multilevel_queue_t queue, int level, void* i
  */
 extern int multilevel_queue_dequeue(multilevel_queue_t queue, int level, void** item);
 
+/*
+ * Delete the specified item from whichever level it is on.
+ * Return the level the item was deleted from, or -1 (failure).
+ */
+extern int multilevel_queue_delete(multilevel_queue_t queue, void* item);
+
+/*
+ * Iterate f over the items of every level, from level 0 up, as queue_iterate does.
+ * Stop early and return -1 if f returns -1, return 0 otherwise.
+ */
+extern int multilevel_queue_iterate(multilevel_queue_t queue, PFany f, void* arg);
+
+/*
+ * Iterate f over the items of the specified level, as queue_iterate does.
+ * Stop early and return -1 if f returns -1, return 0 otherwise.
+ */
+extern int multilevel_queue_iterate_level(multilevel_queue_t queue, int level, PFany f, void* arg);
+
+/*
+ * Return the level the specified item is on, or -1 if it is not on the queue.
+ */
+extern int multilevel_queue_level(multilevel_queue_t queue, void* item);
+
+/*
+ * Move every item on the specified level to the tail of the level below it.
+ * Only the items of the shorter of the two levels are touched, so raising
+ * a level onto an empty one takes constant time.
+ * Return the number of items moved, or -1 (failure).
+ */
+extern int multilevel_queue_raise(multilevel_queue_t queue, int level);
+
+/*
+ * Return the total number of items on all levels, or -1 if queue is NULL.
+ */
+extern int multilevel_queue_length(multilevel_queue_t queue);
+
 /* 
  * Free the queue and return 0 (success) or -1 (failure). Do not free the queue nodes; this is
  * the responsibility of the programmer.
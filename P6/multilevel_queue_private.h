@@ -4,8 +4,19 @@
 #include "queue.h"
 #include "multilevel_queue.h"
 
+/* Maximum number of levels, one bit each in the non-empty level map */
+#define MULTILEVEL_QUEUE_MAX_LEVELS 32
+
+/*
+ * lvl: number of levels.
+ * len: number of items on all levels.
+ * map: bit i is set when level i is non-empty.
+ * q: queue of each level.
+ */
 struct multilevel_queue {
     int lvl;
+    int len;
+    unsigned int map;
     queue_t *q;
 };
 
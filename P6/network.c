@@ -435,7 +435,7 @@ int network_poll(void* arg) {
      */
     if (DEBUG)
       kprintf("NET:packet arrived.\n");
-    send_interrupt(NETWORK_INTERRUPT_TYPE, mini_network_handler, (void*)packet);
+    send_interrupt_batched(NETWORK_INTERRUPT_TYPE, (void*)packet);
   }
 }
 
@@ -17,12 +17,21 @@ queue_new()
     if ((q = malloc(sizeof(struct queue))) == NULL) {
         return NULL;
     }
-    q->length = 0;
-    q->head = NULL;
-    q->tail = NULL;
+    queue_initialize(q);
     return q;
 }
 
+/*
+ * Make an embedded queue empty.
+ */
+void
+queue_initialize(queue_t queue)
+{
+    queue->length = 0;
+    queue->head = NULL;
+    queue->tail = NULL;
+}
+
 /*
  * Prepend a void* to a queue (both specifed as parameters).  Return
  * 0 (success) or -1 (failure).
@@ -124,6 +133,41 @@ queue_delete(queue_t queue, void** item)
     return 0;
 }
 
+/*
+ * Join the items of queue a followed by those of queue b into one of the
+ * two, and leave the other empty. Only the items of the shorter queue are
+ * relinked to the other. Return the queue holding the items, or NULL
+ * (failure).
+ */
+queue_t
+queue_join(queue_t a, queue_t b)
+{
+    queue_t from, to;
+    node_t node, head, tail;
+    if (NULL == a || NULL == b || a == b)
+        return NULL;
+    if (a->length <= b->length) {
+        from = a;
+        to = b;
+    } else {
+        from = b;
+        to = a;
+    }
+    for (node = from->head; NULL != node; node = node->next)
+        node->queue = to;
+    if (a->length > 0 && b->length > 0) {
+        a->tail->next = b->head;
+        b->head->prev = a->tail;
+    }
+    head = (a->length > 0) ? a->head : b->head;
+    tail = (b->length > 0) ? b->tail : a->tail;
+    to->length = a->length + b->length;
+    to->head = head;
+    to->tail = tail;
+    queue_initialize(from);
+    return to;
+}
+
 /*
  * Iterate the function parameter over each element in the queue.  The
  * additional void* argument is passed to the function as its first
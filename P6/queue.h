@@ -22,6 +22,12 @@ typedef struct queue* queue_t;
  */
 extern queue_t queue_new();
 
+/*
+ * Make the queue structure pointed at by queue empty, for queues embedded
+ * in other structures rather than allocated by queue_new.
+ */
+extern void queue_initialize(queue_t queue);
+
 /*
  * Prepend a void* to a queue (both specifed as parameters).  Return
  * 0 (success) or -1 (failure).
@@ -65,4 +71,11 @@ extern int queue_length(queue_t queue);
  */
 extern int queue_delete(queue_t queue, void** item);
 
+/*
+ * Join the items of queue a followed by those of queue b into one of the
+ * two, and leave the other empty. Only the items of the shorter queue are
+ * touched. Return the queue holding the items, or NULL (failure).
+ */
+extern queue_t queue_join(queue_t a, queue_t b);
+
 #endif /*__QUEUE_H__*/
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <pthread.h>
 #include <string.h>
 #include "read.h"
@@ -24,7 +25,7 @@ semaphore_t new_data;
 
 void read_handler(void* arg) {	
 	struct kb_line* node = (struct kb_line*) arg;
-	set_interrupt_level(DISABLED);
+	interrupt_level_t oldlevel = set_interrupt_level(DISABLED);
 
 	if (kb_head == NULL) {
 		kb_head = node;
@@ -34,8 +35,8 @@ void read_handler(void* arg) {
 		kb_tail = node;
 	}
 
-	set_interrupt_level(ENABLED);
-	semaphore_V(new_data);
+	set_interrupt_level(oldlevel);
+	semaphore_V_io(new_data);
 }
 
 int read_poll(void* arg) {
@@ -46,8 +47,12 @@ int read_poll(void* arg) {
 		new_node = (struct kb_line*) malloc(sizeof(struct kb_line));
 		new_node->next = NULL;
 
-		fgets(new_node->buf, MAX_LINE_LENGTH, stdin);
-	
+		/* Stop at end of input rather than sending empty lines */
+		if (fgets(new_node->buf, MAX_LINE_LENGTH, stdin) == NULL) {
+			free(new_node);
+			return 0;
+		}
+
 		send_interrupt(READ_INTERRUPT_TYPE, read_handler, new_node);
 	}
 }
@@ -3,6 +3,7 @@
 #include <string.h>
 #include <assert.h>
 
+#include "interrupts.h"
 #include "minifile.h"
 #include "minithread.h"
 #include "read.h"
@@ -180,6 +181,10 @@ void help_screen()
     printf(" cp (copy) src dest - copy src file to dest file\n");
     printf(" mv (move) src dest - move src file to dest file\n");
     printf(" whoami - print your identity\n");
+    printf(" ps - print scheduling statistics of all threads\n");
+    printf(" irq [reset] - print (or clear) interrupt latency statistics\n");
+    printf(" irq on|off - start (stop) timing sections with interrupts disabled\n");
+    printf(" sync - write modified blocks back to disk\n");
     printf(" help - show this screen\n");
     printf(" exit - exit shell\n");
     printf("\n");
@@ -245,6 +250,22 @@ int shell(int *g)
             move(arg1,arg2);
         else if(strcmp(func,"whoami") == 0)
             printf("You are minithread %d, running our shell\n",minithread_id());
+        else if(strcmp(func,"ps") == 0)
+            minithread_stats();
+        else if(strcmp(func,"irq") == 0) {
+            if(strcmp(arg1,"reset") == 0)
+                interrupt_stats_reset();
+            else if(strcmp(arg1,"on") == 0)
+                interrupt_time_disabled = 1;
+            else if(strcmp(arg1,"off") == 0)
+                interrupt_time_disabled = 0;
+            else
+                interrupt_stats();
+        }
+        else if(strcmp(func,"sync") == 0) {
+            if(minifile_sync() != 0)
+                printf("sync: Error writing back to disk\n");
+        }
         else if(strcmp(func,"exit") == 0)
             break;
         else if(strcmp(func,"doscmd") == 0)
@@ -23,17 +23,11 @@
 semaphore_t
 semaphore_create()
 {
-    queue_t q;
     semaphore_t sem = malloc(sizeof(struct semaphore));
     if (NULL == sem) {
         return NULL;
     }
-    q = queue_new();
-    if (NULL == q) {
-        free(sem);
-        return NULL;
-    }
-    sem->wait = q;
+    queue_initialize(&(sem->wait));
     return sem;
 }
 
@@ -44,16 +38,14 @@ semaphore_create()
 void
 semaphore_destroy(semaphore_t sem)
 {
-    if (NULL == sem)
-        return;
-    queue_free(sem->wait);
     free(sem);
 }
 
 /*
  * semaphore_initialize(semaphore_t sem, int cnt)
  *    initialize the semaphore data structure pointed at by
- *    sem with an initial value cnt.
+ *    sem with an initial value cnt. sem may be embedded in another
+ *    structure, and must not have threads waiting on it.
  */
 void
 semaphore_initialize(semaphore_t sem, int cnt)
@@ -62,6 +54,7 @@ semaphore_initialize(semaphore_t sem, int cnt)
         return;
     sem->count = cnt;
     sem->lock = 0;
+    queue_initialize(&(sem->wait));
 }
 
 /*
@@ -74,7 +67,7 @@ semaphore_P(semaphore_t sem)
     while (atomic_test_and_set(&(sem->lock)) == 1)
         ;
     if (--(sem->count) < 0) {
-        queue_append(sem->wait, (void*) minithread_self());
+        queue_append(&(sem->wait), (void*) minithread_self());
         minithread_unlock_and_stop(&(sem->lock));
     } else {
         atomic_clear(&(sem->lock));
@@ -82,22 +75,44 @@ semaphore_P(semaphore_t sem)
 }
 
 /*
- * semaphore_V(semaphore_t sem)
- *	V on the sempahore. Your new implementation should use TAS locks.
+ * V on sem, and boost the thread woken up, if any, when boost is set.
  */
-void
-semaphore_V(semaphore_t sem)
+static void
+semaphore_V_boost(semaphore_t sem, int boost)
 {
     minithread_t t;
     while (atomic_test_and_set(&(sem->lock)) == 1)
         ;
     if (++(sem->count) <= 0) {
-        if (queue_dequeue(sem->wait, (void**) &t) == 0)
+        if (queue_dequeue(&(sem->wait), (void**) &t) == 0) {
+            if (boost)
+                minithread_boost(t);
             minithread_start(t);
+        }
     }
     atomic_clear(&(sem->lock));
 }
 
+/*
+ * semaphore_V(semaphore_t sem)
+ *	V on the sempahore. Your new implementation should use TAS locks.
+ */
+void
+semaphore_V(semaphore_t sem)
+{
+    semaphore_V_boost(sem, 0);
+}
+
+/*
+ * semaphore_V_io(semaphore_t sem)
+ *	V on the semaphore and boost the thread woken up.
+ */
+void
+semaphore_V_io(semaphore_t sem)
+{
+    semaphore_V_boost(sem, 1);
+}
+
 void
 semaphore_Signal(void* sem)
 {
@@ -112,3 +127,242 @@ semaphore_new(int cnt)
     semaphore_initialize(sem, cnt);
     return sem;
 }
+
+/*
+ * Mutexes.
+ */
+
+/* Allocate a new unlocked mutex */
+mutex_t
+mutex_create()
+{
+    mutex_t m = malloc(sizeof(struct mutex));
+    if (NULL == m)
+        return NULL;
+    queue_initialize(&(m->wait));
+    m->held = 0;
+    m->lock = 0;
+    m->waiters = 0;
+    m->owner = NULL;
+    return m;
+}
+
+/* Deallocate a mutex */
+void
+mutex_destroy(mutex_t m)
+{
+    free(m);
+}
+
+/*
+ * Acquire the mutex, spinning a few times before blocking. A blocked
+ * thread returns owning the mutex, handed over by mutex_unlock.
+ */
+void
+mutex_lock(mutex_t m)
+{
+    int i;
+    for (i = 0; i <= MUTEX_SPIN; ++i) {
+        if (atomic_test_and_set(&(m->held)) == 0) {
+            m->owner = minithread_self();
+            return;
+        }
+    }
+    while (atomic_test_and_set(&(m->lock)) == 1)
+        ;
+    ++m->waiters;
+    /* The mutex may have been released before waiters was raised */
+    if (atomic_test_and_set(&(m->held)) == 0) {
+        --m->waiters;
+        m->owner = minithread_self();
+        atomic_clear(&(m->lock));
+        return;
+    }
+    queue_append(&(m->wait), (void*) minithread_self());
+    minithread_unlock_and_stop(&(m->lock));
+}
+
+/* Acquire the mutex if it is not held */
+int
+mutex_trylock(mutex_t m)
+{
+    if (atomic_test_and_set(&(m->held)) == 1)
+        return -1;
+    m->owner = minithread_self();
+    return 0;
+}
+
+/* Release the mutex, handing it over to the first waiter if any */
+void
+mutex_unlock(mutex_t m)
+{
+    minithread_t t;
+    assert(m->owner == minithread_self());
+    m->owner = NULL;
+    atomic_clear(&(m->held));
+    if (0 == m->waiters)
+        return;
+    while (atomic_test_and_set(&(m->lock)) == 1)
+        ;
+    /* Another thread may have taken the mutex in the meantime */
+    if (m->waiters > 0 && atomic_test_and_set(&(m->held)) == 0) {
+        if (queue_dequeue(&(m->wait), (void**) &t) == 0) {
+            --m->waiters;
+            m->owner = t;
+            minithread_start(t);
+        } else {
+            atomic_clear(&(m->held));
+        }
+    }
+    atomic_clear(&(m->lock));
+}
+
+/*
+ * Condition variables.
+ */
+
+/* Allocate a new condition variable */
+cond_t
+cond_create()
+{
+    cond_t c = malloc(sizeof(struct cond));
+    if (NULL == c)
+        return NULL;
+    queue_initialize(&(c->wait));
+    c->lock = 0;
+    return c;
+}
+
+/* Deallocate a condition variable */
+void
+cond_destroy(cond_t c)
+{
+    free(c);
+}
+
+/* Release m and wait on c, then reacquire m */
+void
+cond_wait(cond_t c, mutex_t m)
+{
+    while (atomic_test_and_set(&(c->lock)) == 1)
+        ;
+    queue_append(&(c->wait), (void*) minithread_self());
+    mutex_unlock(m);
+    minithread_unlock_and_stop(&(c->lock));
+    mutex_lock(m);
+}
+
+/* Wake up the first thread waiting on c */
+void
+cond_signal(cond_t c)
+{
+    minithread_t t;
+    while (atomic_test_and_set(&(c->lock)) == 1)
+        ;
+    if (queue_dequeue(&(c->wait), (void**) &t) == 0)
+        minithread_start(t);
+    atomic_clear(&(c->lock));
+}
+
+/* Wake up every thread waiting on c */
+void
+cond_broadcast(cond_t c)
+{
+    minithread_t t;
+    while (atomic_test_and_set(&(c->lock)) == 1)
+        ;
+    while (queue_dequeue(&(c->wait), (void**) &t) == 0)
+        minithread_start(t);
+    atomic_clear(&(c->lock));
+}
+
+/*
+ * Reader-writer locks.
+ */
+
+/* Allocate a new unlocked reader-writer lock */
+rwlock_t
+rwlock_create()
+{
+    rwlock_t l = malloc(sizeof(struct rwlock));
+    if (NULL == l)
+        return NULL;
+    queue_initialize(&(l->rd_wait));
+    queue_initialize(&(l->wr_wait));
+    l->lock = 0;
+    l->readers = 0;
+    l->writer = 0;
+    l->writers_waiting = 0;
+    return l;
+}
+
+/* Deallocate a reader-writer lock */
+void
+rwlock_destroy(rwlock_t l)
+{
+    free(l);
+}
+
+/*
+ * Acquire the lock shared. A blocked reader returns holding it, counted
+ * in readers by the thread that woke it up.
+ */
+void
+rwlock_rdlock(rwlock_t l)
+{
+    while (atomic_test_and_set(&(l->lock)) == 1)
+        ;
+    if (0 == l->writer && 0 == l->writers_waiting) {
+        ++l->readers;
+        atomic_clear(&(l->lock));
+        return;
+    }
+    queue_append(&(l->rd_wait), (void*) minithread_self());
+    minithread_unlock_and_stop(&(l->lock));
+}
+
+/* Acquire the lock exclusively */
+void
+rwlock_wrlock(rwlock_t l)
+{
+    while (atomic_test_and_set(&(l->lock)) == 1)
+        ;
+    if (0 == l->writer && 0 == l->readers) {
+        l->writer = 1;
+        atomic_clear(&(l->lock));
+        return;
+    }
+    ++l->writers_waiting;
+    queue_append(&(l->wr_wait), (void*) minithread_self());
+    minithread_unlock_and_stop(&(l->lock));
+}
+
+/* Release the lock, handing it over to the waiters next in line */
+void
+rwlock_unlock(rwlock_t l)
+{
+    minithread_t t;
+    int was_writer;
+    while (atomic_test_and_set(&(l->lock)) == 1)
+        ;
+    was_writer = l->writer;
+    if (was_writer)
+        l->writer = 0;
+    else
+        --l->readers;
+    if (0 == l->readers) {
+        /* Readers held back by this writer go first */
+        if (was_writer) {
+            while (queue_dequeue(&(l->rd_wait), (void**) &t) == 0) {
+                ++l->readers;
+                minithread_start(t);
+            }
+        }
+        if (0 == l->readers && queue_dequeue(&(l->wr_wait), (void**) &t) == 0) {
+            --l->writers_waiting;
+            l->writer = 1;
+            minithread_start(t);
+        }
+    }
+    atomic_clear(&(l->lock));
+}
@@ -7,10 +7,25 @@
  *	You must implement the procedures and types defined in this interface.
  */
 
+#include "machineprimitives.h"
+#include "queue_private.h"
+
 /* Semaphores */
 
 typedef struct semaphore *semaphore_t;
 
+/*
+ * A semaphore can be embedded by value in another structure and set up in
+ * place with semaphore_initialize, which allocates nothing. Its wait queue
+ * is part of it and links the blocked threads through their own control
+ * blocks. An embedded semaphore needs no semaphore_destroy.
+ */
+struct semaphore {
+    int count;
+    tas_lock_t lock;
+    struct queue wait;
+};
+
 /*
  * semaphore_t semaphore_create()
  *	Allocate a new semaphore.
@@ -42,10 +57,105 @@ extern void semaphore_P(semaphore_t sem);
  */
 extern void semaphore_V(semaphore_t sem);
 
+/*
+ * semaphore_V_io(semaphore_t sem)
+ *	V on the semaphore to signal a completed I/O event. The thread woken
+ *	up, if any, is boosted to the highest scheduling priority.
+ */
+extern void semaphore_V_io(semaphore_t sem);
+
 /* Same as semaphore_V, but taking void* argument (for alarm) */
 extern void semaphore_Signal(void* sem);
 
 /* Create a new semaphore with count initialized to cnt */
 extern semaphore_t semaphore_new(int cnt);
 
+/* Mutexes */
+
+typedef struct mutex *mutex_t;
+
+/*
+ * mutex_t mutex_create()
+ *	Allocate a new mutex, unlocked.
+ *
+ * mutex_destroy(mutex_t m)
+ *	Deallocate a mutex. It must not be held.
+ */
+extern mutex_t mutex_create();
+extern void mutex_destroy(mutex_t m);
+
+/*
+ * mutex_lock(mutex_t m)
+ *	Acquire m. An unheld mutex is taken without touching its wait
+ *	queue. A held one is retried a few times, then the caller blocks
+ *	until m is handed over to it.
+ *
+ * int mutex_trylock(mutex_t m)
+ *	Acquire m if it is not held. Return 0 if acquired, -1 if not.
+ *
+ * mutex_unlock(mutex_t m)
+ *	Release m, which must be held by the caller. If a thread is waiting,
+ *	m is handed over to the first one.
+ */
+extern void mutex_lock(mutex_t m);
+extern int mutex_trylock(mutex_t m);
+extern void mutex_unlock(mutex_t m);
+
+/* Condition variables */
+
+typedef struct cond *cond_t;
+
+/*
+ * cond_t cond_create()
+ * cond_destroy(cond_t c)
+ *	Allocate or deallocate a condition variable.
+ */
+extern cond_t cond_create();
+extern void cond_destroy(cond_t c);
+
+/*
+ * cond_wait(cond_t c, mutex_t m)
+ *	Atomically release m, which the caller must hold, and wait on c.
+ *	m is held again when cond_wait returns. Wake-ups may be spurious, so
+ *	the caller should recheck its condition.
+ *
+ * cond_signal(cond_t c)
+ * cond_broadcast(cond_t c)
+ *	Wake up the first thread, or every thread, waiting on c.
+ */
+extern void cond_wait(cond_t c, mutex_t m);
+extern void cond_signal(cond_t c);
+extern void cond_broadcast(cond_t c);
+
+/* Reader-writer locks */
+
+typedef struct rwlock *rwlock_t;
+
+/*
+ * rwlock_t rwlock_create()
+ * rwlock_destroy(rwlock_t l)
+ *	Allocate a new unlocked reader-writer lock, or deallocate one. It must
+ *	not be held when deallocated.
+ */
+extern rwlock_t rwlock_create();
+extern void rwlock_destroy(rwlock_t l);
+
+/*
+ * rwlock_rdlock(rwlock_t l)
+ *	Acquire l shared with other readers. Writers are preferred: a reader
+ *	blocks while a writer holds l or is waiting for it.
+ *
+ * rwlock_wrlock(rwlock_t l)
+ *	Acquire l exclusively, blocking until the readers holding it leave.
+ *
+ * rwlock_unlock(rwlock_t l)
+ *	Release l, held shared or exclusively by the caller. The last reader
+ *	to leave hands l over to the first waiting writer. A writer leaving
+ *	hands it over to every reader that queued behind it, if any, and
+ *	otherwise to the next writer.
+ */
+extern void rwlock_rdlock(rwlock_t l);
+extern void rwlock_wrlock(rwlock_t l);
+extern void rwlock_unlock(rwlock_t l);
+
 #endif /*__SYNCH_H__*/
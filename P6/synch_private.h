@@ -1,10 +1,45 @@
 #ifndef __SYNCH_PRIVATE_H__
 #define __SYNCH_PRIVATE_H__
 
-struct semaphore {
-    int count;
+/*
+ * Times mutex_lock retries a held mutex before blocking. Virtual
+ * processors share one host thread, so the owner rarely runs while the
+ * caller spins and the retries are kept few.
+ */
+#define MUTEX_SPIN 16
+
+/*
+ * held: 1 while the mutex is held, taken with test-and-set.
+ * lock: protects waiters and wait.
+ * waiters: threads blocked or about to block on the mutex.
+ * owner: thread holding the mutex.
+ */
+struct mutex {
+    tas_lock_t held;
+    tas_lock_t lock;
+    int waiters;
+    minithread_t owner;
+    struct queue wait;
+};
+
+struct cond {
+    tas_lock_t lock;
+    struct queue wait;
+};
+
+/*
+ * lock: protects every other field.
+ * readers: threads holding the lock shared.
+ * writer: 1 while a thread holds the lock exclusively.
+ * writers_waiting: threads blocked in rwlock_wrlock.
+ */
+struct rwlock {
     tas_lock_t lock;
-    queue_t wait;
+    int readers;
+    int writer;
+    int writers_waiting;
+    struct queue rd_wait;
+    struct queue wr_wait;
 };
 
 #endif /*__SYNCH_PRIVATE_H__*/